@@ -10,6 +10,8 @@
 #define SUPREME_LIMBCTRL_F411RE_HPP
 
 #include <xpcc/architecture/platform.hpp>
+#include <src/dma_uart.hpp>
+#include <src/adc_dma.hpp>
 
 using namespace xpcc::stm32;
 
@@ -24,7 +26,7 @@ struct systemClock {
 	static constexpr uint32_t Apb1 = Frequency / 2;
 	static constexpr uint32_t Apb2 = Frequency;
 
-//	static constexpr uint32_t Adc    = Apb2;
+	static constexpr uint32_t Adc    = Apb2 / 4; /* ADCPRE, see adc_dma.hpp */
 
 //	static constexpr uint32_t Spi1   = Apb2;
 //	static constexpr uint32_t Spi2   = Apb1;
@@ -91,6 +93,17 @@ using ain_vbat   = GpioC1;
 
 using stat_vbat  = GpioA0;
 
+/* supply and battery voltage, sampled continuously, both inputs have a
+   nominal voltage divider of 1:11 (100k/10k), i.e. 36.3 V full scale at
+   3.3 V reference. The schematic is not part of this repository, hence
+   the full scale is part of the board config (see config.hpp) and can be
+   calibrated per board against a meter, see tools/set_config.py. */
+constexpr uint8_t  ain_ub_channel    = 10; /* ADC1_IN10 */
+constexpr uint8_t  ain_vbat_channel  = 11; /* ADC1_IN11 */
+constexpr uint16_t ain_nominal_full_scale_mV = 3300 * 11;
+
+using health_adc = supreme::AdcDma<16, ain_ub_channel, ain_vbat_channel>;
+
 using mot_pwr_en = GpioA7;
 using com_pwr_en = GpioA6;
 
@@ -109,12 +122,14 @@ struct rs485_interface {
 	using drive_input  = typename Interface::drive_input;
 	using read_disable = typename Interface::read_disable;
 	using drive_enable = typename Interface::drive_enable;
-	using uart         = typename Interface::uart;
+	using uart         = supreme::DmaUart<typename Interface::uart, 256, 160>; /* tx: full slot of 4 motors, see topology.hpp */
+
+	static constexpr unsigned baud = baudrate;
 
 	static void initialize(void) {
-		drive_input::connect(uart::Tx);
-		read_output::connect(uart::Rx);
-		uart::template initialize<systemClock, baudrate>(12); // 1Mbaud/s
+		drive_input::connect(Interface::uart::Tx);
+		read_output::connect(Interface::uart::Rx);
+		uart::template initialize<systemClock, baudrate>();
 		drive_enable::setOutput();
 		read_disable::setOutput();
 		read_disable::reset();     // set to receive mode
@@ -184,6 +199,12 @@ initialize()
 	led_red::reset();
 
 
+	/* board health, sampled by ADC and DMA */
+	ain_ub::setAnalogInput();
+	ain_vbat::setAnalogInput();
+	stat_vbat::setInput();
+	health_adc::initialize();
+
 	/* setup rs485 interfaces */
 	rs485_spinalcord::initialize();
 	rs485_motorcord ::initialize();
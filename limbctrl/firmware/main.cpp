@@ -13,6 +13,22 @@
 #include <src/communication.hpp>
 
 #include <src/motorcord.hpp>
+#include <src/cyclecounter.hpp>
+#include <src/topology.hpp>
+#include <src/slottable.hpp>
+#include <src/config.hpp>
+#include <src/config_port.hpp>
+#include <src/flash.hpp>
+#include <src/controller.hpp>
+#include <src/cpg.hpp>
+#include <src/robotstate.hpp>
+#include <src/syncdiag.hpp>
+#include <src/clocksync.hpp>
+#include <src/leader.hpp>
+#include <src/events.hpp>
+#include <src/cpuload.hpp>
+#include <src/trace.hpp>
+#include <src/health.hpp>
 
 using namespace Board;
 using namespace supreme;
@@ -35,31 +51,96 @@ enum CycleState {
 	duplicate_id,
 };
 
+/* events of the interrupts, the main loop sleeps until the next one */
+namespace event {
+	enum : uint32_t {
+		frame_start = 1 << 0, /* GlobalSync: next frame */
+		send_slot   = 1 << 1, /* LocalDelay: own slot */
+		comm_end    = 1 << 2, /* MotorTimer: all slots are over */
+
+		/* wake-ups, their data is in flags or the uarts' buffers */
+		motor_timer = 1 << 3,
+		rx_timeout  = 1 << 4,
+		spinal_rx   = 1 << 5,
+		spinal_tx   = 1 << 6,
+		external_rx = 1 << 7,
+
+		wakeups = motor_timer | rx_timeout | spinal_rx | spinal_tx | external_rx,
+	};
+} /* namespace event */
+
 /* 3 Mbaud/s = 3.000.000 baud/s = 300.000 byte/s
    with 10 bit per byte (8N1)
    -> 3.34 us per byte
 */
-constexpr uint8_t board_id = 3;    //TODO read from EEPROM
+
+/* robot topology, determines slot and transparent frame sizes,
+   a config's topology must fit into these */
+constexpr topology::Table const& robot = topology::quadruped;
 
 constexpr unsigned byte_transmission_time_us = 10; //TODO
 constexpr unsigned deadtime_us = 20;
-constexpr unsigned bytes_per_slot = 64;
+constexpr unsigned bytes_per_slot = topology::slot_size(robot);
+constexpr unsigned transparent_bytes = topology::transparent_bytes(robot.num_voltages);
 constexpr unsigned slottime_us = bytes_per_slot * byte_transmission_time_us + deadtime_us;
 
-constexpr uint8_t trunk_id = 4;
 constexpr uint8_t syncbyte = 0x55;
 constexpr uint8_t max_id = 7;
-constexpr unsigned frametime_us = 10000; /* 10.000 us = 10 ms = 100 Hz */
-constexpr unsigned local_delay_us = board_id * slottime_us + deadtime_us;
 
-constexpr unsigned motortime_us = frametime_us - 2000;
+/* frame timing, i.e. frame rate, order and length of slots and start of the
+   motor phase, is given by the slot table. The default table has slots for
+   all boards in order of their id, fitted to their number of motors,
+   10.000 us = 10 ms = 100 Hz frames and motors are updated 2 ms before
+   the end of the frame. The table of the
+   config is loaded at boot instead, the leading board distributes its table
+   to all other boards. */
+typedef slottable::Schedule<byte_transmission_time_us, deadtime_us, topology::slot_bytes(0)> Schedule_t;
+constexpr slottable::Table default_slots = slottable::make_fitted(100, 80, robot);
+
+/* derating of the motors' pwm limit under low supply voltage (see
+   health.hpp), the default assumes a 12 V supply (3S pack, 9.6 V cut-off) */
+constexpr health::Derating default_derating = { 10500, 9600, 5000 };
+
+/* ext. sensors are prefetched every 10th tick of the motors, i.e. one
+   sample per default frame (see motorcord.hpp) */
+constexpr uint8_t default_ext_sensor_divider = 10;
+
+/* board id, trunk role, topology, slot table, derating, full scale of
+   the voltage inputs and the ext. sensor prefetch are read from the
+   config in flash at boot, the defaults are used until a config was
+   stored. A new config is received via the external port, see
+   config_port.hpp. */
+typedef config::Store<ConfigSector> ConfigStore;
+constexpr config::Config default_config = { 3, 0, robot, default_slots, default_derating, ain_nominal_full_scale_mV
+                                          , default_ext_sensor_divider, {0,0,0} };
+constexpr unsigned config_window_ms = 500; /* trunk only */
+
+bool is_valid_config(config::Config const& c) {
+	return config::is_valid<Schedule_t>(c, bytes_per_slot, robot.num_voltages);
+}
 
-constexpr bool is_trunk_controller = (board_id == trunk_id);
+uint8_t board_id = default_config.board_id;
+bool is_trunk_controller = false;
 
 // constexpr unsigned full_size = bytes_per_slot * (max_id+1);
 
 static_assert(slottime_us > 0);
-static_assert(local_delay_us > 0);
+static_assert(topology::is_valid(robot));
+static_assert(bytes_per_slot < 256);
+static_assert(Schedule_t::is_valid(default_slots));
+static_assert(config::is_valid<Schedule_t>(default_config, bytes_per_slot, robot.num_voltages));
+
+/* on-limb controller stage, enabled by config flag 'local':
+   computes the targets of this board's motors from the sensor data
+   of all boards, the network's weights are kept in flash */
+typedef controller::SensorInputs<robot.num_voltages> SensorInputs_t;
+typedef controller::RecurrentNetwork<SensorInputs_t::size, 2, robot.num_voltages> Network_t;
+
+static_assert(SensorInputs_t::connected_status == is_connected);
+
+/* target voltages are held for 3 frames without new setpoints
+   (e.g. a late transparent frame), then decay by 1/4 per frame */
+constexpr setpoints::Policy setpoint_policy = { setpoints::decay, 3, 2 };
 
 /*
 	5 boards à 400 us = 2000 us = 2 ms communication time
@@ -67,7 +148,7 @@ static_assert(local_delay_us > 0);
 
 	/// cycle partition ///
 	0.0 communication
-	2.0 start neural calculations
+	2.0 start neural calculations (after last slot, see slot table)
 	8.0 update motors
 	    + write motors
 	    + read motors
@@ -85,75 +166,316 @@ void signal_leading(uint8_t ref_id) {
 
 /* variables used by timer ISRs */
 volatile bool rx_timed_out = false;
-volatile bool sendnow      = false;
-volatile bool syncnow      = false;
 volatile bool write_motors = false; //TODO rename
 
+volatile unsigned motortime_us = 0;
+volatile unsigned commtime_us  = 0;
+volatile bool     comm_phase   = false; /* MotorTimer times the end of the communication */
+volatile bool     has_slot     = false;
+volatile uint32_t frame_started = 0; /* cycle counter */
+
+EventQueue events;
+
+/* CPU time per state, see cpuload.hpp */
+CpuLoad<duplicate_id + 1> cpu_load;
+
+/* trunk only: forwarding of all slots to the external port, drained by ISR,
+   either one by one or aggregated to one frame per cycle (config flag 'aggregate') */
+typedef RobotState<topology::max_boards, bytes_per_slot, syncbyte> RobotState_t;
+SpinalCordFull<rs485_external, RobotState_t::max_bytes> sc_full;
+RobotState_t robot_state;
+bool aggregate = false;
+
+/* trace of the frame cycle, dumped on request via the external port */
+typedef trace::Ring<512> Trace_t;
+Trace_t trace_ring;
+trace::Dump<Trace_t> trace_dump(trace_ring);
 
-void apply_global_sync(uint8_t ref_id) {
-	unsigned synctime_us = frametime_us - ref_id * slottime_us;
-	setperiod_and_restart_timer<GlobalSync>(synctime_us);
+static_assert(trace::chunk_bytes <= RobotState_t::max_bytes);
+
+void trace_event(trace::Kind kind, uint8_t arg = 0, uint8_t data = 0) {
+	trace_ring.add(kind, cyclecounter::now(), arg, data);
+}
+
+template <typename Buffer_t>
+void forward(Buffer_t const& buffer, unsigned length) {
+	if (aggregate)
+		robot_state.add(buffer, length);
+	else
+		sc_full.start_transmission(buffer, length);
+}
+
+Schedule_t schedule;
+
+/* GlobalSync times the frames, see clocksync.hpp */
+clocksync::Pll pll;
+
+/* GlobalSync (TIM2, 32 bit) runs continuously without prescaler, i.e. in
+   core clock cycles. The period is buffered and applies to the next frame,
+   a restart does not trigger the interrupt. */
+void init_frame_timer(void) {
+	TIM2->PSC  = 0;
+	TIM2->CR1 |= TIM_CR1_ARPE | TIM_CR1_URS;
+}
+
+void restart_frame_timer(uint32_t period) {
+	TIM2->ARR  = period - 1;
+	TIM2->EGR  = TIM_EGR_UG;
+	TIM2->CR1 |= TIM_CR1_CEN;
+}
+
+void preload_frame_timer(uint32_t period) { TIM2->ARR = period - 1; }
+
+/* (re-)program timers after loading a slot table,
+   must be called while LocalDelay and MotorTimer are paused */
+void apply_schedule(void) {
+	LocalDelay::setPeriod<Board::systemClock>(schedule.get_local_delay_us());
+	LocalDelay::applyAndReset();
+	LocalDelay::pause();
+	motortime_us = schedule.get_motortime_us();
+	commtime_us  = schedule.get_comm_us();
+	has_slot = schedule.has_own_slot();
+	pll.set_nominal(cyclecounter::from_us(schedule.get_frametime_us()));
 }
 
 bool we_are(uint8_t ref_id) { return board_id == ref_id; }
 
+/* transmission time of the two sync bytes, 3 Mbaud, 10 bit per byte */
+constexpr uint32_t sync_bytes_cycles = 2 * 10 * (Board::systemClock::Frequency / 3000000);
+
+/* phase errors above are corrected by a restart of the frame timer */
+constexpr int32_t max_phase = cyclecounter::from_us(deadtime_us) / 2;
+
+/* start of the slot of board <ref_id> against the own frame timer */
+int32_t get_phase(uint8_t ref_id, uint32_t sync_time) {
+	return sync_time - sync_bytes_cycles - frame_started
+	     - cyclecounter::from_us(schedule.get_slot_start_us(ref_id));
+}
+
+/* hard sync: next frame starts one frame after the start of the slot
+   of board <ref_id>, minus the slot's offset */
+void restart_to(uint8_t ref_id, uint32_t sync_time, uint8_t frame) {
+	const uint32_t frame_start = sync_time - sync_bytes_cycles
+	                           - cyclecounter::from_us(schedule.get_slot_start_us(ref_id));
+	__disable_irq();
+	restart_frame_timer(frame_start + pll.get_nominal() - cyclecounter::now());
+	preload_frame_timer(pll.lock(sync_time, ref_id, frame));
+	__enable_irq();
+}
+
+/* this board leads, its frame timer runs on the own clock */
+void lead(void) {
+	__disable_irq();
+	preload_frame_timer(pll.lead());
+	__enable_irq();
+}
+
+syncdiag::SyncDiagnostics sync_diag;
+
+/* carrier for voltage setpoints, TODO integrate in SC-Data structure */
+typedef supreme::MotorCord<rs485_motorcord, MotorTimer, robot.num_voltages> MotorCord_t;
+
+/* derating of the motors' pwm limit under low supply voltage, the
+   thresholds are taken from the config at boot */
+health::Monitor board_health(MotorCord_t::limit_pwm, default_derating);
+
+/* status byte of the slot, switching every 16 frames: sync diagnostics (see
+   syncdiag.hpp), fault log (see faults.hpp), sync diagnostics, board health
+   (see health.hpp) */
+uint8_t get_status_byte(uint8_t frame) {
+	switch ((frame / 16) % 4) {
+		case 1 : return fault_log.get_byte(frame);
+		case 3 : return board_health.get_byte(frame);
+		default: return sync_diag.get_byte(frame);
+	}
+}
+
+/* time stamps the start of the leading board's slot */
+void measure_sync(int32_t phase, uint8_t ref_id, uint32_t sync_time, uint8_t frame) {
+	static uint32_t last_time  = 0;
+	static uint8_t  last_frame = 0;
+	static uint8_t  last_id    = 0xff;
+
+	const bool consecutive = (ref_id == last_id and frame == (uint8_t) (last_frame + 1));
+	const int32_t period = sync_time - last_time - cyclecounter::from_us(schedule.get_frametime_us());
+	sync_diag.measure(cyclecounter::to_ns(phase) / 100, cyclecounter::to_ns(period), consecutive);
+
+	last_time  = sync_time;
+	last_frame = frame;
+	last_id    = ref_id;
+}
+
+/* follows the leading board by trimming the frame timer's period */
+void sync_to(uint8_t ref_id, uint32_t sync_time, uint8_t frame) {
+	const int32_t phase = get_phase(ref_id, sync_time);
+	measure_sync(phase, ref_id, sync_time, frame);
+
+	if (pll.is_locked() and phase < max_phase and phase > -max_phase) {
+		__disable_irq();
+		preload_frame_timer(pll.measure(phase, sync_time, ref_id, frame));
+		__enable_irq();
+	}
+	else
+		restart_to(ref_id, sync_time, frame);
+}
+
+/* sleeps until the next interrupt, unless an event is pending or bytes
+   of the spinal cord or the external port are waiting (if given). The
+   receive interrupts are one-shot wake-ups, armed before checking. The
+   check is done with interrupts masked, a pending interrupt still ends
+   the sleep and is served after unmasking. The SysTick (1 ms) wakes at
+   the latest, e.g. for the failover's timing. */
+void sleep(bool spinal, bool external) {
+	if (spinal)   rs485_spinalcord::uart::enableReceiveInterrupt();
+	if (external) rs485_external::uart::enableReceiveInterrupt();
+	__disable_irq();
+	if (events.empty()
+	    and not (spinal   and rs485_spinalcord::uart::available() > 0)
+	    and not (external and rs485_external::uart::available() > 0))
+	{
+		__DSB();
+		__WFI();
+	}
+	__enable_irq();
+}
+
+/* stores a received config and restarts the board to apply it */
+template <typename Port>
+void receive_config(Port& port) {
+	if (not port.read()) return;
+	if (port.is_dump_request()) {
+		trace_dump.start();
+		return;
+	}
+	const config::Config c = port.get();
+	if (not is_valid_config(c)) return;
+	if (ConfigStore::store(c)) {
+		port.acknowledge(c);
+		NVIC_SystemReset();
+	}
+}
+
 int
 main()
 {
 	Board::initialize();
-
-	init_timer<GlobalSync, frametime_us*10>();
-	init_timer<LocalDelay, local_delay_us>();
-	init_timer<MotorTimer, motortime_us  >();
+	cyclecounter::initialize();
+
+	config::Config const* stored = ConfigStore::load();
+	config::Config const& cfg = (stored != nullptr and is_valid_config(*stored)) ? *stored : default_config;
+	board_id = cfg.board_id;
+	is_trunk_controller = cfg.is_trunk();
+	aggregate = cfg.is_aggregate();
+	fault_log.set_halt_all(cfg.is_halt());
+	board_health.set_derating(cfg.derating);
+
+	ConfigPort<rs485_external> config_port;
+
+	/* the trunk's external port carries transparent data,
+	   it accepts a new config only within a short time after reset */
+	if (is_trunk_controller) {
+		const uint32_t started = cyclecounter::now();
+		while (cyclecounter::to_us(cyclecounter::elapsed(started)) < config_window_ms * 1000)
+			receive_config(config_port);
+	}
+
+	/* periods are set by the schedule */
+	init_timer<GlobalSync, slottime_us>();
+	init_frame_timer();
+	init_timer<LocalDelay, slottime_us>();
+	init_timer<MotorTimer, slottime_us>();
+
+	schedule.set_topology(cfg.topology, cfg.is_compact());
+	schedule.load(cfg.slots, board_id);
+	apply_schedule();
+
+	/* below timers, which must not be delayed */
+	rs485_spinalcord::uart::enableInterruptVector(11); /* wake-ups */
+	sc_full.initialize(12); /* wake-ups, forwarding (trunk only) */
 
 	CycleState state = initializing;
 
 	uint8_t leading_id = board_id; // assume, until we know better
-	uint8_t transparent_mode = 0;
+	uint8_t table_source = board_id; // leading board of the last frame
 	uint8_t board_list = 0;
 	uint8_t last_board_list = 0;
 
-	bool timer_started = false;
+	bool timer_started = false; /* synced to the leader in this frame */
+
+	uint8_t traced_state = 0xff; /* none */
 
-	/* carrier for voltage setpoints, TODO integrate in SC-Data structure */
-	typedef supreme::MotorCord<rs485_motorcord, MotorTimer, board_id, 3> MotorCord_t;
-	typedef supreme::SpinalCord<rs485_spinalcord, bytes_per_slot, syncbyte, MotorCord_t, board_id> SpinalCord_t;
+	LeaderElection election(board_id);
+	std::array<uint32_t, topology::max_boards> slot_times = {}; /* sync time of the slots of this frame */
 
-	MotorCord_t::target_voltage_t target_voltages;
-	target_voltages.fill(float_to_sc(0.0));
+	typedef supreme::SpinalCord<rs485_spinalcord, bytes_per_slot, syncbyte, MotorCord_t> SpinalCord_t;
 
-	MotorCord_t motorcord(target_voltages);
-	SpinalCord_t spinalcord(motorcord);
+	MotorCord_t::Setpoints_t setpoints(setpoint_policy);
 
-	supreme::CommunicationController<RxTimeout, syncbyte, max_id, bytes_per_slot, slottime_us, MotorCord_t::target_voltage_t> com(&rx_timed_out, target_voltages);
+	MotorCord_t motorcord(setpoints, cfg.topology.boards[board_id]);
+	SpinalCord_t spinalcord(motorcord, board_id, cfg.is_compact());
 
-	SpinalCordFull<rs485_external> sc_full;
+	supreme::CommunicationController<RxTimeout, syncbyte, max_id, bytes_per_slot, slottime_us, MotorCord_t::Setpoints_t> com(&rx_timed_out, setpoints);
 
-	typedef TransparentData<rs485_external, rs485_spinalcord> TransparentData_t;
+	typedef TransparentData<rs485_external, rs485_spinalcord, transparent_bytes> TransparentData_t;
 	TransparentData_t transparent_data;
 
 	uint8_t cycles = 0;
 
-	xpcc::delayMicroseconds(500); // give motors some time to boot up TODO: can we do better?
-	if (not is_trunk_controller)
-		motorcord.initialize(&write_motors); /* ping and setup */
+	SensorInputs_t sensors;
+	Network_t network(controller::quadruped_cpg);
+	const bool local_control = cfg.is_local();
+	bool computed = false;
+	bool comm_over = false; /* all slots of this frame are over */
 
 	/* Enable reading of accelsensor, TODO: where to put this? */
-	if (board_id == 0)
+	if (board_id == 0 and motorcord.get_num_motors() > 0)
 		motorcord.set_motors()[0].enable_ext_sensor_reading();
+	motorcord.set_ext_sensor_prefetch(cfg.ext_sensor_divider);
+
+	if (not is_trunk_controller)
+		motorcord.initialize(&write_motors); /* discover and setup */
 
 	while (1)
 	{
+		cpu_load.mark(state, cyclecounter::now());
+		events.take(event::wakeups); /* later interrupts end the next sleep */
+
+		if (state != traced_state) {
+			trace_event(trace::state, state);
+			fault_log.set_state(state);
+			traced_state = state;
+		}
 
 		/* other stuff */
-		sc_full.check_transmission_finished();
+		spinalcord.check_transmission_finished();
+
+		if (not is_trunk_controller)
+			receive_config(config_port);
+
+		/* the leader's slot is over and was not received,
+		   the next lowest board takes over within this frame */
+		if ((state == receiving or state == receiving_2) and not timer_started
+		    and not (board_list & (1 << election.get_leader()))
+		    and cyclecounter::to_us(cyclecounter::elapsed(frame_started)) > schedule.get_slot_end_us(election.get_leader()))
+		{
+			leading_id = election.failover();
+			trace_event(trace::failover, leading_id);
+			if (we_are(leading_id)) {
+				lead();
+				timer_started = true;
+			}
+			else if (board_list & (1 << leading_id)) { /* its slot was received before */
+				sync_to(leading_id, slot_times[leading_id], cycles);
+				timer_started = true;
+			}
+		}
 
 		switch(state)
 		{
 		case initializing: /* start first frame and try to (re-)sync */
 			state = synchronizing;
-			GlobalSync::pause();
-			setperiod_and_restart_timer<GlobalSync>(10*frametime_us);
+			pll.reset();
+			restart_frame_timer(10 * pll.get_nominal());
 			leading_id = board_id;
 			led_red::reset();
 			led_ylw::reset();
@@ -167,17 +489,17 @@ main()
 				uint8_t slot_id = com.get_received_id();
 
 				/* sync to the first board you can find */
-				apply_global_sync(slot_id);
+				restart_to(slot_id, com.get_sync_time(), cycles);
 				leading_id = slot_id;
-				while (!syncnow) {} // note: syncnow is set by GlobalSync ISR
+				board_list = (1 << board_id) | (1 << slot_id);
+				while (not events.take(event::frame_start)) {}
 
-				syncnow = false;
 				state = synchronized;
 			}
 			else {
-				if (syncnow) { // tried enough finding a leading board
-					syncnow = false;
-					apply_global_sync(board_id);
+				if (events.take(event::frame_start)) { // tried enough finding a leading board
+					lead();
+					board_list = 1 << board_id;
 					state = synchronized;
 				};
 			}
@@ -189,12 +511,32 @@ main()
 			led_ylw::reset();
 			signal_leading(leading_id);
 			++cycles;
+			trace_ring.set_frame(cycles);
+			setpoints.next_frame(cycles);
+			sync_diag.next_frame(cycles);
+			fault_log.set_frame(cycles);
+			fault_log.next_frame(cycles);
+			cpu_load.next_frame(cycles);
+			board_health.update( health::to_mV(health_adc::average(0), cfg.ain_full_scale_mV)
+			                   , health::to_mV(health_adc::average(1), cfg.ain_full_scale_mV)
+			                   , stat_vbat::read() );
+			board_health.next_frame(cycles);
+			motorcord.set_pwm_limit(board_health.get_pwm_limit());
 
 			state = receiving;
-			leading_id = board_id; // reset
+			table_source = leading_id;
 			last_board_list = board_list;
 			board_list = 1 << board_id;
-			timer_started = false;
+			election.begin(last_board_list);
+			leading_id = election.get_leader();
+			timer_started = election.we_lead();
+			if (timer_started)
+				lead();
+			computed = false;
+			comm_over = false;
+			sensors.clear(); /* boards whose slot is lost have no inputs */
+			if (is_trunk_controller and aggregate)
+				robot_state.begin(cycles);
 			break;
 
 		case receiving:
@@ -202,70 +544,118 @@ main()
 			{
 				uint8_t slot_id = com.get_received_id();
 				board_list |= 1 << slot_id;
-
-				if (slot_id < leading_id)
-					leading_id = slot_id;
+				slot_times[slot_id] = com.get_sync_time();
+				trace_ring.add(trace::slot, com.get_sync_time(), slot_id, com.get_length());
 
 				/* we found the leading board */
-				if (!we_are(leading_id) and !timer_started and slot_id == leading_id)
+				if (!timer_started and slot_id == leading_id)
 				{
-					apply_global_sync(leading_id);
+					sync_to(leading_id, com.get_sync_time(), cycles);
 					timer_started = true;
 				}
 
 				if (slot_id == board_id) // someone is using our id!
 					state = duplicate_id;
 
+				if (slot_id == table_source)
+					schedule.receive_slot(com.get(), com.get_length());
+
+				sensors.read_slot(com.get(), com.get_length());
+
 				if (is_trunk_controller)
-					sc_full.start_transmission(com.get());
+					forward(com.get(), com.get_length());
 			}
 
-			if (sendnow) {
-				sendnow = false;
+			if (events.take(event::send_slot))
 				state = transmitting;
-			}
+			else if (write_motors) /* no slot of our own in this table */
+				state = receiving_2;
 
 			break;
 
 		case transmitting:
 			led_red::reset();
-			spinalcord.prepare( leading_id, transparent_mode, last_board_list,
-			                     com.packets, com.errors, cycles );
-			spinalcord.transmit();
-			if (we_are(leading_id)) { // we are the leading board must sync to ourselves
-				apply_global_sync(board_id);
-			 	timer_started = true;
-			}
+			spinalcord.prepare( leading_id, get_status_byte(cycles), last_board_list,
+			                     com.packets, com.errors, cycles,
+			                     schedule.get_chunk(cycles) );
+			spinalcord.start_transmission(); /* DMA, bus is released in main loop */
+			rs485_spinalcord::uart::enableTransmitCompleteInterrupt(); /* wakes for the release */
 
 			if (is_trunk_controller)
-				sc_full.start_transmission(spinalcord.get());
+				forward(spinalcord.get(), spinalcord.get_length());
 
 			state = receiving_2;
 			break;
 
 		case receiving_2:
 
-			if (!timer_started) { // something went wrong
-				state = initializing;
+			if (!timer_started and write_motors) { // no leader found in this frame
+				if (pll.holdover())
+					timer_started = true; /* keep the estimated frame timing */
+				else
+					state = initializing;
+				trace_event(trace::holdover, pll.get_missed());
 			}
 
 			if (com.read_slot())
 			{
 				uint8_t slot_id = com.get_received_id();
 				board_list |= 1 << slot_id;
+				slot_times[slot_id] = com.get_sync_time();
+				trace_ring.add(trace::slot, com.get_sync_time(), slot_id, com.get_length());
+
+				/* leader's slot after our own */
+				if (!timer_started and slot_id == leading_id)
+				{
+					sync_to(leading_id, com.get_sync_time(), cycles);
+					timer_started = true;
+				}
+
+				if (slot_id == table_source)
+					schedule.receive_slot(com.get(), com.get_length());
+
+				sensors.read_slot(com.get(), com.get_length());
 
 				if (is_trunk_controller)
-					sc_full.start_transmission(com.get());
+					forward(com.get(), com.get_length());
 			}
 
 			if (is_trunk_controller && transparent_data.read()) {
-				transparent_data.write();
-				++transparent_mode;
+				if (transparent_data.is_dump_request())
+					trace_dump.start();
+				else
+					transparent_data.write();
+			}
+
+			if (events.take(event::comm_end) or write_motors)
+				comm_over = true;
+
+			/* controller stage, after all slots were received */
+			if (local_control and not computed and comm_over)
+			{
+				sensors.read_motors(motorcord);
+				network.step(sensors.get());
+				computed = true;
+			}
+
+			/* all slots of this frame are in, send them to the host at once */
+			if (is_trunk_controller and aggregate and robot_state.is_open() and comm_over)
+			{
+				robot_state.finish();
+				sc_full.start_transmission(robot_state.get(), robot_state.get_length());
 			}
 
 			if (write_motors) {
 				state = writing_motors;
 				write_motors = false;
+				if (computed) { /* overrides targets from transparent data */
+					auto& target_voltages = setpoints.begin_write();
+					for (uint8_t i = 0; i < motorcord.get_num_motors(); ++i) {
+						const uint8_t id = motorcord.get_motors()[i].get_id();
+						target_voltages[id] = float_to_sc(network.output(id));
+					}
+					setpoints.commit();
+				}
 				motorcord.prepare();
 			}
 			break;
@@ -275,25 +665,45 @@ main()
 			{
 			case MotorCord_t::State_t::done:
 				state = idle;
-				/*Fall through*/
-			case MotorCord_t::State_t::waiting_for_next:
 				write_motors = false;
+				events.take(event::send_slot | event::comm_end); /* missed in this frame */
+				if (trace_dump.is_active()) { /* one chunk per frame */
+					std::array<uint8_t, trace::chunk_bytes> chunk;
+					const unsigned length = trace_dump.next<syncbyte>(board_id, chunk);
+					sc_full.start_transmission(chunk.data(), length);
+				}
 				break;
 			default: break;
 			} // switch
 			break;
 
 		case idle:
-			if (syncnow) {
+			/* adopt the leading board's slot table at the end of the frame */
+			if (schedule.update(board_id))
+				apply_schedule();
+
+			if (events.take(event::frame_start))
 				state = synchronized;
-				syncnow = false;
-			}
 			break;
 
 		case duplicate_id: error_state(); break;
 
 		} // switch(state)
 
+		/* nothing to do until the next event or byte, busy states are
+		   synchronized, transmitting and writing_motors */
+		const bool reading  = (state == synchronizing or state == receiving or state == receiving_2);
+		const bool external = is_trunk_controller ? (state == receiving_2) : true;
+		const bool waiting  = (not reading or com.is_waiting())
+		                  and (not external or (is_trunk_controller ? transparent_data.is_waiting()
+		                                                            : config_port.is_waiting()));
+		if ((reading or state == idle) and waiting)
+		{
+			cpu_load.mark(state, cyclecounter::now());
+			sleep(reading, external);
+			cpu_load.slept(cyclecounter::now());
+		}
+
 	} // while(1)
 	return 0;
 }
@@ -302,13 +712,17 @@ main()
 /* Timer Interrupt Service Routines */
 XPCC_ISR(TIM2)
 {
-	LocalDelay::start();
-	MotorTimer::setPeriod<Board::systemClock>(motortime_us);
+	frame_started = cyclecounter::now();
+	if (has_slot)
+		LocalDelay::start();
+	/* two shots: end of communication, then motor phase */
+	comm_phase = (commtime_us < motortime_us);
+	MotorTimer::setPeriod<Board::systemClock>(comm_phase ? commtime_us : motortime_us);
 	MotorTimer::start();
 	GlobalSync::acknowledgeInterruptFlags(GlobalSync::InterruptFlag::Update);
-	GlobalSync::applyAndReset();
-	GlobalSync::pause();
-	syncnow = true;
+	preload_frame_timer(pll.next_frame()); /* free running, see clocksync.hpp */
+	events.post(event::frame_start);
+	trace_ring.add(trace::frame_start, frame_started);
 }
 
 XPCC_ISR(TIM3)
@@ -316,7 +730,8 @@ XPCC_ISR(TIM3)
 	LocalDelay::acknowledgeInterruptFlags(LocalDelay::InterruptFlag::Update);
 	LocalDelay::applyAndReset();
 	LocalDelay::pause();
-	sendnow = true; // trigger sending own data now
+	events.post(event::send_slot); // trigger sending own data now
+	trace_event(trace::send_slot);
 }
 
 XPCC_ISR(TIM4)
@@ -325,6 +740,8 @@ XPCC_ISR(TIM4)
 	RxTimeout::applyAndReset();
 	RxTimeout::pause();
 	rx_timed_out = true;
+	events.post(event::rx_timeout);
+	trace_event(trace::rx_timeout);
 
 	//TODO remove reset here, to check for timed out from elsewhere, just pause... and get rid of the additional bools, only pause the timer here. do not ackknowledge here. do the ack in the "is_timed_out()" method
 }
@@ -332,7 +749,41 @@ XPCC_ISR(TIM4)
 XPCC_ISR(TIM5)
 {
 	MotorTimer::acknowledgeInterruptFlags(MotorTimer::InterruptFlag::Update);
+	if (comm_phase) { /* continues to the motor phase */
+		comm_phase = false;
+		setperiod_and_restart_timer<MotorTimer>(motortime_us - commtime_us);
+		events.post(event::comm_end);
+		trace_event(trace::comm_end);
+		return;
+	}
 	MotorTimer::applyAndReset();
 	MotorTimer::pause();
 	write_motors = true;
+	events.post(event::motor_timer);
+	trace_event(trace::motor_phase);
+}
+
+/* UART Interrupt Service Routines */
+XPCC_ISR(USART1) /* spinal cord, wake-ups only */
+{
+	using uart = rs485_spinalcord::uart;
+	if (uart::isTransmitComplete()) {
+		uart::disableTransmitCompleteInterrupt();
+		events.post(event::spinal_tx);
+	}
+	if (uart::isReceiveInterruptEnabled()) {
+		uart::disableReceiveInterrupt();
+		events.post(event::spinal_rx);
+	}
+}
+
+XPCC_ISR(USART6) /* external port */
+{
+	using uart = rs485_external::uart;
+	if (uart::isTransmitComplete())
+		sc_full.transmit_complete();
+	if (uart::isReceiveInterruptEnabled()) {
+		uart::disableReceiveInterrupt();
+		events.post(event::external_rx);
+	}
 }
@@ -0,0 +1,96 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_ADC_DMA_HPP
+#define SUPREME_LIMBCTRL_ADC_DMA_HPP
+
+#include <xpcc/architecture/platform.hpp>
+
+namespace supreme {
+
+/* ADC1 in continuous scan mode, the DMA (DMA2 S0 Ch0, RM0383 Table 28)
+   writes the conversions into a circular buffer of NumScans scans of
+   all channels, hence sampling costs no CPU time. Reading averages
+   over the buffer, i.e. the last NumScans scans.
+
+   The ADC runs at PCLK2/4 = 24 MHz with the longest sample time (480
+   cycles) for the high impedance voltage dividers, i.e. one scan of
+   two channels takes 41 us. The pins must be set to analog input. */
+template <unsigned NumScans, uint8_t... Channels>
+class AdcDma {
+	static constexpr unsigned NumChannels = sizeof...(Channels);
+	static constexpr unsigned NumSamples  = NumScans * NumChannels;
+
+	static_assert(NumChannels > 0 and NumChannels <= 6, "Channels must fit into SQR3.");
+	static_assert(NumSamples <= 0xffff, "Buffer exceeds DMA transfer size.");
+
+	static volatile uint16_t buffer[NumSamples];
+
+	static constexpr uint32_t sequence(void) {
+		uint32_t sqr = 0;
+		unsigned i = 0;
+		for (uint8_t ch : {Channels...})
+			sqr |= (uint32_t) ch << (5 * i++);
+		return sqr;
+	}
+
+	/* sample time 480 cycles (7) for all channels */
+	static void set_sample_times(void) {
+		for (uint8_t ch : {Channels...}) {
+			if (ch < 10) ADC1->SMPR2 |= 7u << (3 * ch);
+			else         ADC1->SMPR1 |= 7u << (3 * (ch - 10));
+		}
+	}
+
+public:
+	static void initialize(void)
+	{
+		RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+		RCC->APB2ENR |= RCC_APB2ENR_ADC1EN;
+
+		ADC->CCR   = (ADC->CCR & ~ADC_CCR_ADCPRE) | ADC_CCR_ADCPRE_0; /* PCLK2/4 */
+		ADC1->CR2  = 0;
+		ADC1->CR1  = ADC_CR1_SCAN; /* 12 bit */
+		ADC1->SMPR1 = 0;
+		ADC1->SMPR2 = 0;
+		set_sample_times();
+		ADC1->SQR1 = (NumChannels - 1) << 20;
+		ADC1->SQR2 = 0;
+		ADC1->SQR3 = sequence();
+
+		/* peripheral to memory, 16 bit, circular, low priority */
+		DMA_Stream_TypeDef* s = DMA2_Stream0;
+		s->CR &= ~DMA_SxCR_EN;
+		while (s->CR & DMA_SxCR_EN);
+		DMA2->LIFCR = 0x3D; /* TC, HT, TE, DME, FE of stream 0 */
+		s->PAR  = (uint32_t) &ADC1->DR;
+		s->M0AR = (uint32_t) buffer;
+		s->NDTR = NumSamples;
+		s->FCR  = 0; /* direct mode */
+		s->CR   = DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC; /* channel 0 */
+		s->CR  |= DMA_SxCR_EN;
+
+		ADC1->CR2 = ADC_CR2_ADON | ADC_CR2_CONT | ADC_CR2_DMA | ADC_CR2_DDS;
+		xpcc::delayMicroseconds(3); /* ADC stabilization time */
+		ADC1->CR2 |= ADC_CR2_SWSTART;
+	}
+
+	/* mean of the last NumScans conversions of the i-th channel [0..4095] */
+	static uint16_t average(uint8_t i) {
+		uint32_t sum = 0;
+		for (unsigned k = i; k < NumSamples; k += NumChannels)
+			sum += buffer[k];
+		return sum / NumScans;
+	}
+};
+
+template <unsigned NumScans, uint8_t... Channels>
+volatile uint16_t AdcDma<NumScans, Channels...>::buffer[NumScans * sizeof...(Channels)];
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_ADC_DMA_HPP */
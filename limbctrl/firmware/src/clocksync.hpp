@@ -0,0 +1,140 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_CLOCKSYNC_HPP
+#define SUPREME_LIMBCTRL_CLOCKSYNC_HPP
+
+#include <cstdint>
+
+namespace supreme {
+
+/* Drift compensated synchronization of the frame timer to the leading
+   board, all times in timer ticks (= core clock cycles).
+
+   The frame timer runs continuously, its period is buffered, i.e. a new
+   period applies to the next frame. Once per frame, the start of the
+   leader's slot is time stamped:
+
+     drift: the time between the time stamps of consecutive frames minus
+            the nominal frame time, i.e. the leader's frame time in this
+            board's clock, averaged (1/2^drift_shift per frame)
+     phase: leader's slot start minus the expected start from the own
+            frame timer (positive: leader is late)
+
+   The next frame's period is nominal + drift + phase/2^phase_shift, where
+   the phase is predicted to the start of that frame. Without time stamps,
+   frames are timed with nominal + drift (holdover), until max_holdover
+   frames were missed, then the board has lost sync. */
+namespace clocksync {
+
+	constexpr uint8_t drift_shift  = 3;
+	constexpr uint8_t phase_shift  = 1;
+	constexpr uint8_t max_holdover = 8; /* frames */
+
+	class Pll {
+	public:
+		Pll(uint32_t nominal = 0) : nominal(nominal) { reset(); }
+
+		void set_nominal(uint32_t n) { nominal = n; reset(); }
+
+		void reset(void) {
+			locked    = false;
+			has_drift = false;
+			drift_acc = 0;
+			missed    = 0;
+			current   = nominal;
+			preloaded = nominal;
+		}
+
+		/* hard sync, after the frame timer was restarted to the leader */
+		uint32_t lock(uint32_t timestamp, uint8_t ref_id, uint8_t frame) {
+			if (ref_id != last_id) {
+				has_drift = false;
+				drift_acc = 0;
+			}
+			locked = true;
+			missed = 0;
+			remember(timestamp, ref_id, frame);
+			return preloaded = holdover_period();
+		}
+
+		/* this board leads, i.e. runs on its own clock */
+		uint32_t lead(void) {
+			reset();
+			last_id = 0xff;
+			return preloaded;
+		}
+
+		/* at frame start: the preloaded period is the current one,
+		   returns the period to preload for the next frame */
+		uint32_t next_frame(void) {
+			current = preloaded;
+			return preloaded = holdover_period();
+		}
+
+		/* time stamp of the leader's slot and its phase error in this
+		   frame, returns the period to preload for the next frame */
+		uint32_t measure(int32_t phase, uint32_t timestamp, uint8_t ref_id, uint8_t frame) {
+			if (ref_id == last_id and frame == (uint8_t) (last_frame + 1)) {
+				const int32_t d = (int32_t) (timestamp - last_time - nominal);
+				if (has_drift)
+					drift_acc += d - (drift_acc >> drift_shift);
+				else
+					drift_acc = d << drift_shift;
+				has_drift = true;
+			}
+			else if (ref_id != last_id) {
+				has_drift = false;
+				drift_acc = 0;
+			}
+			missed = 0;
+			remember(timestamp, ref_id, frame);
+
+			/* phase at the start of the next frame */
+			const int32_t next_phase = phase + (int32_t) (nominal - current) + get_drift();
+			return preloaded = holdover_period() + (next_phase >> phase_shift);
+		}
+
+		/* frame without time stamp, returns false if sync is lost */
+		bool holdover(void) {
+			if (not locked) return false;
+			if (++missed > max_holdover) locked = false;
+			return locked;
+		}
+
+		bool     is_locked (void) const { return locked; }
+		int32_t  get_drift (void) const { return drift_acc >> drift_shift; }
+		uint32_t get_period(void) const { return current; }
+		uint32_t get_nominal(void) const { return nominal; }
+		uint8_t  get_missed(void) const { return missed; }
+
+	private:
+		uint32_t holdover_period(void) const { return nominal + get_drift(); }
+
+		void remember(uint32_t timestamp, uint8_t ref_id, uint8_t frame) {
+			last_time  = timestamp;
+			last_id    = ref_id;
+			last_frame = frame;
+		}
+
+		uint32_t nominal;
+		uint32_t current    = 0; /* period of the current frame */
+		uint32_t preloaded  = 0; /* period of the next frame */
+		int32_t  drift_acc  = 0; /* drift << drift_shift */
+		uint32_t last_time  = 0;
+		uint8_t  last_id    = 0xff;
+		uint8_t  last_frame = 0;
+		uint8_t  missed     = 0;
+		bool     locked     = false;
+		bool     has_drift  = false;
+	};
+
+} /* namespace clocksync */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_CLOCKSYNC_HPP */
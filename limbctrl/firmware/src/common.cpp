@@ -6,9 +6,12 @@
  +---------------------------------*/
 
 #include <src/common.hpp>
+#include <src/cyclecounter.hpp>
 
 namespace supreme {
 
+FaultLog_t fault_log;
+
 void blink(uint8_t code) {
 	for (uint8_t i = 0; i < 8; ++i)
 	{
@@ -30,8 +33,7 @@ void blink(uint8_t code) {
 }
 
 
-void assert(bool condition, uint8_t code) {
-	if (condition) return;
+void halt(uint8_t code) {
 	led_red::reset();
 	led_ylw::reset();
 	while(1) {
@@ -40,6 +42,18 @@ void assert(bool condition, uint8_t code) {
 	}
 }
 
+faults::Policy fault(uint8_t code) {
+	const faults::Policy p = fault_log.record(code, cyclecounter::now());
+	if (p == faults::halt)
+		halt(code);
+	return p;
+}
+
+void assert(bool condition, uint8_t code) {
+	if (not condition)
+		fault(code);
+}
+
 void error_state() {
 	assert(false, 0);
 }
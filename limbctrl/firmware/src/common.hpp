@@ -10,14 +10,22 @@
 
 #include <boards/limbctrl_f411re.hpp>
 #include <xpcc/architecture/platform.hpp>
+#include <src/faults.hpp>
 
 using namespace Board;
 
 namespace supreme {
 
+	typedef faults::Log<16> FaultLog_t;
+	extern FaultLog_t fault_log;
+
 	void error_state(void);
 	void assert(bool condition, uint8_t code);
 
+	/* records a fault, halts if the code's policy says so,
+	   otherwise returns the policy, see faults.hpp */
+	faults::Policy fault(uint8_t code);
+
 } /* namespace supreme */
 
 #endif /* SUPREME_LIMBCTRL_COMMON_HPP */
@@ -9,24 +9,37 @@
 #define SUPREME_LIMBCTRL_COMMUNICATION_HPP
 
 #include <array>
+#include <tuple>
 #include <xpcc/architecture/platform.hpp>
+#include <src/topology.hpp>
+#include <src/cyclecounter.hpp>
+#include <src/telemetry.hpp>
 
 using namespace Board;
 
 namespace supreme {
 
-/* Handles communication with other limbs via spinal cord
+/* Handles communication with other limbs via spinal cord,
+   slots are of variable length (see topology::slot_bytes),
+   BytesPerSlot is the max. slot length. Slots with compact
+   telemetry are expanded to the full format after reading.
 */
-template <typename TimerType, uint8_t SyncByte, uint8_t MaxID, unsigned BytesPerSlot, unsigned SlotTime_us, typename target_voltage_t>
+template <typename TimerType, uint8_t SyncByte, uint8_t MaxID, unsigned BytesPerSlot, unsigned SlotTime_us, typename Setpoints_t>
 class CommunicationController {
 public:
 
-	static const unsigned TranspDataSize = 28;
+	/* 2 sync, id, 2 bytes per voltage, checksum */
+	static const unsigned TranspDataSize = 3 + 2 * std::tuple_size<typename Setpoints_t::Values_t>::value + 1;
+	static const unsigned MinSlotBytes = topology::slot_bytes(0);
+
+	/* transmission time of one byte, 10 bit per byte */
+	static constexpr uint32_t byte_cycles = 10 * (Board::systemClock::Frequency / rs485_spinalcord::baud);
 
 	enum recv_state_t {
 		initializing = 0,
 		synchronizing,
 		awaiting_id,
+		reading_length,
 		reading_spinal_data,
 		reading_transp_data,
 		validating,
@@ -43,6 +56,8 @@ public:
 	uint8_t errors = 0;
 
 	uint8_t received_id = 255;
+	uint8_t slot_length = 0;
+	uint32_t sync_time  = 0; /* cycle counter at arrival of the sync bytes */
 
 	uint8_t data = 0;
 	typedef std::array<uint8_t, BytesPerSlot> Buffer_t;
@@ -51,13 +66,18 @@ public:
 	bool sync_state = false;
 	volatile bool *rx_timed_out;
 
-	target_voltage_t& target_voltages;
+	Setpoints_t& setpoints;
 	bool transp_mode = false;
 
-	CommunicationController(volatile bool *timed_out, target_voltage_t& target_voltages)
+	telemetry::Decoder<topology::max_boards, topology::max_motors_per_board> decoder;
+	Buffer_t expanded;
+
+	CommunicationController(volatile bool *timed_out, Setpoints_t& setpoints)
 	: buffer()
 	, rx_timed_out(timed_out)
-	, target_voltages(target_voltages)
+	, setpoints(setpoints)
+	, decoder()
+	, expanded()
 	{
 		static_assert(TranspDataSize < BytesPerSlot);
 		buffer.fill(0);
@@ -73,13 +93,11 @@ public:
 		buffer.fill(0); /* TODO only clear what has been written so far */
 		bytecount = 0;
 		checksum = 0;
+		slot_length = 0;
 		return recv_state_t::synchronizing;
 	}
 
-	void eat() {
-		uint8_t dump;
-		while(rs485_spinalcord::uart::read(dump));
-	}
+	void eat() { rs485_spinalcord::uart::discardReceiveBuffer(); }
 
 	bool byte_received(void) {
 		bool result = rs485_spinalcord::uart::read(data);
@@ -95,11 +113,22 @@ public:
 	{
 		if (checksum == 0) {
 			received_id = buffer[2];
-			return success;
+			return (transp_mode or expand()) ? success : recv_state_t::error;
 		}
 		return recv_state_t::error;
 	}
 
+	bool expand()
+	{
+		if (0 == (buffer[telemetry::header_bytes-1] & telemetry::compact_flag))
+			return true; /* full format */
+		const unsigned len = telemetry::expand(decoder, buffer, slot_length, expanded);
+		if (len == 0) return false;
+		buffer = expanded;
+		slot_length = len;
+		return true;
+	}
+
 	recv_state_t get_sync_bytes()
 	{
 		if (data != SyncByte) {
@@ -110,6 +139,10 @@ public:
 		if (sync_state) {
 			/* Sync found, set timeout and continue reading. */
 			sync_state = false;
+			/* the bytes of a slot arrive back to back, the ones behind the
+			   sync bytes tell how long ago they arrived, independent of
+			   the main loop's latency, within one byte time */
+			sync_time = cyclecounter::now() - rs485_spinalcord::uart::available() * byte_cycles;
 			reset_and_start_timer<TimerType>();
 			return recv_state_t::awaiting_id;
 		}
@@ -121,7 +154,7 @@ public:
 	recv_state_t get_id()
 	{	/* check for valid id */
 		if (data < MaxID) {
-			return reading_spinal_data;
+			return reading_length;
 		}
 		else if (data == 0xff) {
 			transp_mode = true;
@@ -130,9 +163,17 @@ public:
 		else return error;
 	}
 
+	recv_state_t get_length_byte()
+	{
+		if (data < MinSlotBytes or data > BytesPerSlot)
+			return error;
+		slot_length = data;
+		return reading_spinal_data;
+	}
+
 	recv_state_t get_spinal_data()
 	{
-		return (bytecount < BytesPerSlot) ? reading_spinal_data : validating;
+		return (bytecount < slot_length) ? reading_spinal_data : validating;
 	}
 
 	recv_state_t get_transp_data()
@@ -142,6 +183,15 @@ public:
 
 	uint8_t get_received_id() const { return received_id; }
 
+	/* length of the last slot read, incl. sync bytes and checksum */
+	uint8_t get_length() const { return slot_length; }
+
+	/* cycle counter when the sync bytes of the last slot arrived */
+	uint32_t get_sync_time() const { return sync_time; }
+
+	/* waiting for the next byte, i.e. read_slot() has nothing to do without new data */
+	bool is_waiting(void) const { return state >= synchronizing and state <= reading_transp_data; }
+
 	bool read_slot(void)
 	{
 		bool result = false;
@@ -165,6 +215,7 @@ public:
 
 			case synchronizing      : if (byte_received()) state = get_sync_bytes();   break;
 			case awaiting_id        : if (byte_received()) state = get_id();           break;
+			case reading_length     : if (byte_received()) state = get_length_byte();  break;
 			case reading_spinal_data: if (byte_received()) state = get_spinal_data();  break;
 			case reading_transp_data: if (byte_received()) state = get_transp_data();  break;
 			case validating         :                      state = verify_checksum();  break;
@@ -194,10 +245,12 @@ public:
 	}
 
 	void copy_transparent_data(void) {
-		for (unsigned i = 0; i < 12; ++i) {
+		auto& target_voltages = setpoints.begin_write();
+		for (unsigned i = 0; i < target_voltages.size(); ++i) {
 			unsigned offset = 3; // 2 x sync + id
 			target_voltages[i] = (uint16_t) (buffer[2*i+offset] << 8 | buffer[2*i+1+offset]);
 		}
+		setpoints.commit();
 	}
 
 };
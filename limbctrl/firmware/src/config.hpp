@@ -0,0 +1,164 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_CONFIG_HPP
+#define SUPREME_LIMBCTRL_CONFIG_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <src/topology.hpp>
+#include <src/slottable.hpp>
+#include <src/health.hpp>
+
+namespace supreme {
+
+/* Board configuration, stored in flash (emulated EEPROM), such that
+   one firmware image serves all boards of a robot. */
+namespace config {
+
+	enum Flags : uint8_t {
+		trunk     = 0x01, /* trunk controller */
+		compact   = 0x02, /* compact telemetry, see telemetry.hpp */
+		local     = 0x04, /* local controller, see controller.hpp */
+		aggregate = 0x08, /* trunk sends one frame per cycle, see robotstate.hpp */
+		halt      = 0x10, /* every fault halts the board, see faults.hpp */
+	};
+
+	struct Config {
+		uint8_t          board_id;
+		uint8_t          flags;
+		topology::Table  topology;
+		slottable::Table slots;
+		health::Derating derating;          /* supply thresholds [mV], see health.hpp */
+		uint16_t         ain_full_scale_mV; /* of the supply and battery inputs, see board header */
+		uint8_t          ext_sensor_divider; /* ext. sensor prefetch, n-th tick of the motors, 0: off */
+		uint8_t          reserved[3];
+
+		bool is_trunk    (void) const { return flags & trunk;     }
+		bool is_compact  (void) const { return flags & compact;   }
+		bool is_local    (void) const { return flags & local;     }
+		bool is_aggregate(void) const { return flags & aggregate; }
+		bool is_halt     (void) const { return flags & halt;      }
+	};
+
+	static_assert(sizeof(Config) == 68, "Config must be packed.");
+
+	/* config must fit the compiled slot and voltage sizes */
+	template <typename Schedule_t>
+	constexpr bool is_valid(Config const& c, unsigned slot_capacity, unsigned voltage_capacity) {
+		return (c.flags & ~(trunk | compact | local | aggregate | halt)) == 0
+		   and c.board_id < c.topology.num_boards
+		   and topology::is_valid(c.topology, slot_capacity, voltage_capacity)
+		   and Schedule_t::is_valid(c.slots)
+		   and slottable::fits(c.slots, c.topology, c.flags & compact)
+		   and health::is_valid(c.derating)
+		   and c.ain_full_scale_mV > 0;
+	}
+
+	inline uint16_t crc16(uint8_t const* data, unsigned len) {
+		uint16_t crc = 0xFFFF; /* CRC-16/CCITT */
+		for (unsigned i = 0; i < len; ++i) {
+			crc ^= (uint16_t) data[i] << 8;
+			for (uint8_t b = 0; b < 8; ++b)
+				crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+		}
+		return crc;
+	}
+
+	/* Log-structured store in one flash sector: every change appends a
+	   record, the last complete record is the current config. The marker
+	   is programmed last, hence an interrupted write is skipped. When the
+	   sector is full, it is erased and the log starts over. A power loss
+	   during erase loses the config, the defaults are used then.
+
+	   Flash must provide: size, data(), erase() and program(offset, word),
+	   where erase sets all bytes to 0xFF and programming only clears bits. */
+	template <typename Flash>
+	class Store {
+
+		struct Record {
+			Config   config;
+			uint16_t crc;
+			uint16_t reserved;
+			uint32_t marker;
+		};
+
+		static_assert(sizeof(Record) % 4 == 0, "Record must be word aligned.");
+
+		static constexpr uint32_t valid_marker = 0x434F4E46; /* "CONF" */
+		static constexpr unsigned max_records  = Flash::size / sizeof(Record);
+		static constexpr unsigned record_words = sizeof(Record) / 4;
+
+		static Record const& record(unsigned i) {
+			return *reinterpret_cast<Record const*>(Flash::data() + i * sizeof(Record));
+		}
+
+		static bool is_free(unsigned i) {
+			uint8_t const* p = Flash::data() + i * sizeof(Record);
+			for (unsigned k = 0; k < sizeof(Record); ++k)
+				if (p[k] != 0xFF) return false;
+			return true;
+		}
+
+		static bool is_complete(unsigned i) {
+			Record const& r = record(i);
+			return r.marker == valid_marker
+			   and r.crc == crc16(reinterpret_cast<uint8_t const*>(&r.config), sizeof(Config));
+		}
+
+	public:
+
+		/* returns the current config, nullptr if none was stored */
+		static Config const* load(void) {
+			Config const* current = nullptr;
+			for (unsigned i = 0; i < max_records and not is_free(i); ++i)
+				if (is_complete(i))
+					current = &record(i).config;
+			return current;
+		}
+
+		/* appends the config, returns false if programming failed */
+		static bool store(Config const& c) {
+			Config const* current = load();
+			if (current != nullptr and 0 == std::memcmp(current, &c, sizeof(Config)))
+				return true; /* unchanged, save a write cycle */
+
+			unsigned idx = 0;
+			while (idx < max_records and not is_free(idx)) ++idx;
+			if (idx == max_records) {
+				if (not Flash::erase()) return false;
+				idx = 0;
+			}
+
+			Record r;
+			r.config   = c;
+			r.crc      = crc16(reinterpret_cast<uint8_t const*>(&c), sizeof(Config));
+			r.reserved = 0xFFFF;
+			r.marker   = valid_marker;
+
+			uint32_t words[record_words];
+			std::memcpy(words, &r, sizeof(Record));
+			const uint32_t offset = idx * sizeof(Record);
+			for (unsigned k = 0; k < record_words; ++k) /* marker last */
+				if (not Flash::program(offset + 4*k, words[k])) return false;
+
+			return is_complete(idx);
+		}
+
+		/* number of records written since last erase */
+		static unsigned get_num_records(void) {
+			unsigned n = 0;
+			while (n < max_records and not is_free(n)) ++n;
+			return n;
+		}
+	};
+
+} /* namespace config */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_CONFIG_HPP */
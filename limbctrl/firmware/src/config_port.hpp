@@ -0,0 +1,130 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_CONFIG_PORT_HPP
+#define SUPREME_LIMBCTRL_CONFIG_PORT_HPP
+
+#include <src/transceivebuffer.hpp>
+#include <src/config.hpp>
+#include <src/trace.hpp>
+
+namespace supreme {
+
+/* Receives a board configuration via the external port:
+   2 sync, id 0xFE, config (68 bytes), checksum.
+   The received config is acknowledged by sending it back with the
+   same frame, after it was stored. A request to dump the trace
+   (2 sync, id 0xFC, checksum, see trace.hpp) is received as well. */
+template <typename Interface, uint8_t SyncByte = 0x55>
+class ConfigPort
+{
+	static const uint8_t  config_id = 0xFE;
+	static const unsigned NumBytes  = 3 + sizeof(config::Config) + 1;
+
+	bool sync_state = false;
+	uint8_t id = 0;
+
+	recvbuffer<Interface, NumBytes>           recv;
+	sendbuffer<Interface, NumBytes, SyncByte> send;
+
+public:
+
+	enum recv_state_t {
+		initializing = 0,
+		synchronizing,
+		reading_id,
+		reading_data,
+		validating,
+		success,
+		error,
+		done
+	};
+
+	recv_state_t state = initializing;
+
+	ConfigPort() : recv(), send() {}
+
+	/* returns true, if a config or a dump request was received */
+	bool read(void)
+	{
+		bool result = false;
+
+		switch(state)
+		{
+			case initializing:
+				sync_state = false;
+				recv.reset();
+				state = synchronizing;
+				/* fall through */
+
+			case synchronizing: if (recv.read_byte()) state = get_sync_bytes();   break;
+			case reading_id   : if (recv.read_byte()) state = get_id();           break;
+			case reading_data : if (recv.read_byte()) state = get_data();         break;
+			case validating   : state = recv.verify() ? success : error;          break;
+			case success      : result = true;  state = done; break;
+			case error        : result = false; state = done; break;
+			case done:
+			default:
+				state = initializing; // start over again
+				break;
+
+		} // switch(state)
+
+		return result;
+	}
+
+	/* waiting for the next byte, i.e. read() has nothing to do without new data */
+	bool is_waiting(void) const { return state >= synchronizing and state <= reading_data; }
+
+	bool is_dump_request(void) const { return id == trace::dump_id; }
+
+	config::Config get(void) const {
+		config::Config c;
+		std::memcpy(&c, recv.get_buffer().data() + 3, sizeof(config::Config));
+		return c;
+	}
+
+	void acknowledge(config::Config const& c) {
+		uint8_t const* p = reinterpret_cast<uint8_t const*>(&c);
+		send.add_byte(config_id);
+		for (unsigned i = 0; i < sizeof(config::Config); ++i)
+			send.add_byte(p[i]);
+		send.transmit();
+	}
+
+private:
+
+	recv_state_t get_sync_bytes()
+	{
+		if (recv.get_data() != SyncByte) {
+			sync_state = false;
+			return recv_state_t::done;
+		}
+
+		if (sync_state) {
+			sync_state = false;
+			return recv_state_t::reading_id;
+		}
+
+		sync_state = true;
+		return recv_state_t::synchronizing;
+	}
+
+	recv_state_t get_id() {
+		id = recv.get_data();
+		return (id == config_id or id == trace::dump_id) ? reading_data : error;
+	}
+
+	recv_state_t get_data() {
+		const unsigned expected = (id == trace::dump_id) ? trace::request_bytes : NumBytes;
+		return (recv.bytes_received() < expected) ? reading_data : validating;
+	}
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_CONFIG_PORT_HPP */
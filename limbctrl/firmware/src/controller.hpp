@@ -0,0 +1,160 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_CONTROLLER_HPP
+#define SUPREME_LIMBCTRL_CONTROLLER_HPP
+
+#include <array>
+#include <cstdint>
+#include <src/telemetry.hpp>
+
+namespace supreme {
+
+/* On-limb controller stage: computes the motor targets from the sensor
+   data of all boards, in the time between the end of the spinal cord
+   slots and the start of the motor phase. */
+namespace controller {
+
+	/* position, velocity, current per motor */
+	constexpr uint8_t channels = 3;
+
+	/* position (unsigned, 10 bit in Q6) is centred and scaled to [-1,+1),
+	   velocity and current (signed 16 bit) are scaled to approx. [-1,+1] */
+	constexpr float position_scale = 1.f / 32768;
+	constexpr float input_scale    = 1.f / 1024;
+
+	/* tanh, Pade approximant [7/6], clamped to +-1 where both
+	   errors are equal, abs. error < 1e-4 */
+	inline float tanh(float x) {
+		if (x >  4.97f) return  1.f;
+		if (x < -4.97f) return -1.f;
+		const float x2 = x * x;
+		return x * (135135.f + x2 * (17325.f + x2 * (378.f + x2)))
+		         / (135135.f + x2 * (62370.f + x2 * (3150.f + x2 * 28.f)));
+	}
+
+	/* Sensor data of all motors, indexed by motor id (inputs of motor i
+	   are i*channels...), collected from the spinal cord slots and from
+	   this board's motors. Inputs of motors without data in the current
+	   frame are zero, call clear() at the start of each frame. */
+	template <unsigned NumMotors>
+	class SensorInputs {
+	public:
+		static constexpr unsigned size = NumMotors * channels;
+		typedef std::array<float, size> Inputs_t;
+
+		SensorInputs() : x() {}
+
+		void clear(void) { x.fill(0.f); }
+
+		void set(uint8_t id, bool connected, uint16_t position, uint16_t velocity, uint16_t current) {
+			if (id >= NumMotors) return;
+			float* p = &x[id * channels];
+			p[0] = connected ? ((int32_t) position - 32768) * position_scale : 0.f;
+			p[1] = connected ? (int16_t) velocity * input_scale : 0.f;
+			p[2] = connected ? (int16_t) current  * input_scale : 0.f;
+		}
+
+		/* reads a slot in full format (see spinalcord.hpp) */
+		template <typename Buffer_t>
+		void read_slot(Buffer_t const& slot, unsigned length) {
+			using namespace telemetry;
+			if (length < header_bytes + trailer_bytes or length > slot.size()) return;
+			const uint8_t n = slot[header_bytes-1];
+			if (n & compact_flag or header_bytes + n * full_record + trailer_bytes != length) return;
+
+			for (uint8_t m = 0; m < n; ++m) {
+				const unsigned p = header_bytes + m * full_record;
+				set( slot[p]
+				   , slot[p+1] == connected_status
+				   , slot[p+2] << 8 | slot[p+3]   /* position */
+				   , slot[p+6] << 8 | slot[p+7]   /* velocity */
+				   , slot[p+4] << 8 | slot[p+5]); /* current  */
+			}
+		}
+
+		/* reads this board's motors, see motorcord.hpp */
+		template <typename MotorCord_t>
+		void read_motors(MotorCord_t const& motorcord) {
+			auto const& motors = motorcord.get_motors();
+			for (uint8_t i = 0; i < motorcord.get_num_motors(); ++i) {
+				auto const& s = motors[i].get_status_data();
+				set( motors[i].get_id()
+				   , motors[i].get_connection_status() == connected_status
+				   , s.position, s.velocity, s.current);
+			}
+		}
+
+		Inputs_t const& get(void) const { return x; }
+
+		static constexpr uint8_t connected_status = 4; /* see ux_com.hpp, is_connected */
+
+	private:
+		Inputs_t x;
+	};
+
+	/* Parameters of a recurrent network, kept in flash:
+	   h(t+1) = tanh(W x(t) + U h(t) + b),  y = V h(t+1) */
+	template <unsigned NumInputs, unsigned NumHidden, unsigned NumOutputs>
+	struct Params {
+		float W[NumHidden][NumInputs];
+		float U[NumHidden][NumHidden];
+		float b[NumHidden];
+		float V[NumOutputs][NumHidden];
+		float h0[NumHidden]; /* initial state */
+	};
+
+	/* Recurrent network, e.g. a CPG, with plain float loops, single
+	   precision only, such that it runs on the Cortex-M4's FPU. */
+	template <unsigned NumInputs, unsigned NumHidden, unsigned NumOutputs>
+	class RecurrentNetwork {
+	public:
+		typedef Params<NumInputs, NumHidden, NumOutputs> Params_t;
+
+		RecurrentNetwork(Params_t const& params) : p(params), h(), a() { reset(); }
+
+		void reset(void) {
+			for (unsigned j = 0; j < NumHidden; ++j)
+				h[j] = p.h0[j];
+		}
+
+		void step(std::array<float, NumInputs> const& x) {
+			for (unsigned j = 0; j < NumHidden; ++j) {
+				float sum = p.b[j];
+				for (unsigned i = 0; i < NumInputs; ++i)
+					sum += p.W[j][i] * x[i];
+				for (unsigned k = 0; k < NumHidden; ++k)
+					sum += p.U[j][k] * h[k];
+				a[j] = sum;
+			}
+			for (unsigned j = 0; j < NumHidden; ++j)
+				h[j] = tanh(a[j]);
+		}
+
+		/* output k, only computed on demand, since each
+		   board only needs the outputs of its own motors */
+		float output(unsigned k) const {
+			if (k >= NumOutputs) return 0.f;
+			float sum = 0.f;
+			for (unsigned j = 0; j < NumHidden; ++j)
+				sum += p.V[k][j] * h[j];
+			return sum;
+		}
+
+		std::array<float, NumHidden> const& get_state(void) const { return h; }
+
+	private:
+		Params_t const& p;
+		std::array<float, NumHidden> h;
+		std::array<float, NumHidden> a;
+	};
+
+} /* namespace controller */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_CONTROLLER_HPP */
@@ -0,0 +1,43 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_CPG_HPP
+#define SUPREME_LIMBCTRL_CPG_HPP
+
+#include <src/controller.hpp>
+
+namespace supreme {
+namespace controller {
+
+	/* Example network for the quadruped topology: an SO(2) oscillator
+	   (2 neurons, alpha = 1.1, phi = 0.06, approx. 1 Hz at 100 Hz frames)
+	   drives the first joint of each leg in trot, i.e. motors 0 and 7 in
+	   phase, 1 and 6 in anti-phase. No sensory feedback (W = 0). */
+	typedef Params<12 * channels, 2, 12> QuadrupedCPG_t;
+
+	constexpr float cpg_u_diag = 1.0980206f; /* alpha * cos(phi) */
+	constexpr float cpg_u_offd = 0.0659604f; /* alpha * sin(phi) */
+	constexpr float cpg_amp    = 0.3f;
+
+	constexpr QuadrupedCPG_t quadruped_cpg = {
+		/* W */ {},
+		/* U */ { {  cpg_u_diag, cpg_u_offd }
+		        , { -cpg_u_offd, cpg_u_diag } },
+		/* b */ { 0.f, 0.f },
+		/* V */ { {  cpg_amp, 0.f } /*  0 */
+		        , { -cpg_amp, 0.f } /*  1 */
+		        , {}, {}, {}, {}    /* 2..5 */
+		        , { -cpg_amp, 0.f } /*  6 */
+		        , {  cpg_amp, 0.f } /*  7 */
+		        , {}, {}, {}, {} }, /* 8..11 */
+		/* h0 */ { 0.1f, 0.f },
+	};
+
+} /* namespace controller */
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_CPG_HPP */
@@ -0,0 +1,80 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_CPULOAD_HPP
+#define SUPREME_LIMBCTRL_CPULOAD_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace supreme {
+
+/* CPU time of the main loop per state and asleep, in cycle counter ticks.
+
+   The main loop marks the state it is running in and the time it spent
+   asleep, the time between two marks is accounted to the state of the
+   first one. Interrupts are accounted to whatever they interrupted.
+   Counters are collected over a window of 256 frames (frame counter
+   wrap), then published. At 96 MHz, the 32 bit counters hold windows
+   of up to 44 s, i.e. frames of up to 170 ms. */
+template <unsigned NumStates>
+class CpuLoad {
+public:
+	typedef std::array<uint32_t, NumStates> Counters_t;
+
+	CpuLoad() : busy(), published() {}
+
+	/* time since the last mark was spent in the active state,
+	   <state> becomes the active one */
+	void mark(uint8_t state, uint32_t now) {
+		if (active < NumStates)
+			busy[active] += now - last;
+		active = state;
+		last = now;
+	}
+
+	/* time since the last mark was spent asleep */
+	void slept(uint32_t now) {
+		sleep += now - last;
+		last = now;
+	}
+
+	/* call once per frame, publishes the counters on frame counter wrap */
+	void next_frame(uint8_t frame) {
+		if (frame != 0) return;
+		published = busy;
+		published_sleep = sleep;
+		busy.fill(0);
+		sleep = 0;
+	}
+
+	uint32_t get_busy (uint8_t state) const { return (state < NumStates) ? published[state] : 0; }
+	uint32_t get_sleep(void)          const { return published_sleep; }
+
+	/* busy time of the last window in 1/256 of the total */
+	uint8_t get_load(void) const {
+		uint64_t total_busy = 0;
+		for (auto const& b: published)
+			total_busy += b;
+		const uint64_t total = total_busy + published_sleep;
+		if (total == 0) return 0;
+		const uint64_t load = (total_busy * 256) / total;
+		return (load > 255) ? 255 : load;
+	}
+
+private:
+	Counters_t busy;
+	Counters_t published;
+	uint32_t   sleep           = 0;
+	uint32_t   published_sleep = 0;
+	uint32_t   last            = 0;
+	uint8_t    active          = NumStates; /* none */
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_CPULOAD_HPP */
@@ -0,0 +1,47 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_CYCLECOUNTER_HPP
+#define SUPREME_LIMBCTRL_CYCLECOUNTER_HPP
+
+#include <xpcc/architecture/platform.hpp>
+#include <boards/limbctrl_f411re.hpp>
+
+namespace supreme {
+
+/* Cortex-M4 DWT cycle counter, counts core clock cycles (96MHz),
+   wraps around after ~44s, differences of two readings stay valid. */
+namespace cyclecounter {
+
+	inline void initialize(void) {
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CYCCNT = 0;
+		DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+
+	inline uint32_t now(void) { return DWT->CYCCNT; }
+
+	inline uint32_t elapsed(uint32_t since) { return DWT->CYCCNT - since; }
+
+	constexpr uint32_t to_us(uint32_t cycles) {
+		return cycles / (Board::systemClock::Frequency / 1000000);
+	}
+
+	constexpr uint32_t from_us(uint32_t us) {
+		return us * (Board::systemClock::Frequency / 1000000);
+	}
+
+	/* signed, for differences of less than 2^31/1000 cycles (22 ms) */
+	constexpr int32_t to_ns(int32_t cycles) {
+		return cycles * 1000 / (int32_t) (Board::systemClock::Frequency / 1000000);
+	}
+
+} /* namespace cyclecounter */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_CYCLECOUNTER_HPP */
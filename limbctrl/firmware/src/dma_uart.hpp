@@ -0,0 +1,253 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_DMA_UART_HPP
+#define SUPREME_LIMBCTRL_DMA_UART_HPP
+
+#include <xpcc/architecture/platform.hpp>
+
+namespace supreme {
+
+/* DMA stream assignment of the STM32F411 (RM0383, Table 27/28)
+
+	+--------+------------------+------------------+
+	| UART   | RX               | TX               |
+	+--------+------------------+------------------+
+	| USART1 | DMA2 S2 Ch4      | DMA2 S7 Ch4      |
+	| USART2 | DMA1 S5 Ch4      | DMA1 S6 Ch4      |
+	| USART6 | DMA2 S1 Ch5      | DMA2 S6 Ch5      |
+	+--------+------------------+------------------+
+*/
+template <typename Uart> struct dma_uart_traits;
+
+template <> struct dma_uart_traits<xpcc::stm32::Usart1> {
+	static USART_TypeDef*      usart    (void) { return USART1; }
+	static DMA_TypeDef*        dma      (void) { return DMA2; }
+	static DMA_Stream_TypeDef* rx_stream(void) { return DMA2_Stream2; }
+	static DMA_Stream_TypeDef* tx_stream(void) { return DMA2_Stream7; }
+	static constexpr uint8_t   rx_num  = 2;
+	static constexpr uint8_t   tx_num  = 7;
+	static constexpr uint32_t  channel = 4;
+	static constexpr IRQn_Type irq     = USART1_IRQn;
+
+	static void enable_clocks(void) {
+		RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+		RCC->APB2ENR |= RCC_APB2ENR_USART1EN;
+	}
+	template <typename SystemClock>
+	static constexpr uint32_t frequency(void) { return SystemClock::Usart1; }
+};
+
+template <> struct dma_uart_traits<xpcc::stm32::Usart2> {
+	static USART_TypeDef*      usart    (void) { return USART2; }
+	static DMA_TypeDef*        dma      (void) { return DMA1; }
+	static DMA_Stream_TypeDef* rx_stream(void) { return DMA1_Stream5; }
+	static DMA_Stream_TypeDef* tx_stream(void) { return DMA1_Stream6; }
+	static constexpr uint8_t   rx_num  = 5;
+	static constexpr uint8_t   tx_num  = 6;
+	static constexpr uint32_t  channel = 4;
+	static constexpr IRQn_Type irq     = USART2_IRQn;
+
+	static void enable_clocks(void) {
+		RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+		RCC->APB1ENR |= RCC_APB1ENR_USART2EN;
+	}
+	template <typename SystemClock>
+	static constexpr uint32_t frequency(void) { return SystemClock::Usart2; }
+};
+
+template <> struct dma_uart_traits<xpcc::stm32::Usart6> {
+	static USART_TypeDef*      usart    (void) { return USART6; }
+	static DMA_TypeDef*        dma      (void) { return DMA2; }
+	static DMA_Stream_TypeDef* rx_stream(void) { return DMA2_Stream1; }
+	static DMA_Stream_TypeDef* tx_stream(void) { return DMA2_Stream6; }
+	static constexpr uint8_t   rx_num  = 1;
+	static constexpr uint8_t   tx_num  = 6;
+	static constexpr uint32_t  channel = 5;
+	static constexpr IRQn_Type irq     = USART6_IRQn;
+
+	static void enable_clocks(void) {
+		RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+		RCC->APB2ENR |= RCC_APB2ENR_USART6EN;
+	}
+	template <typename SystemClock>
+	static constexpr uint32_t frequency(void) { return SystemClock::Usart6; }
+};
+
+
+/* UART transport with DMA in both directions, providing the static
+   interface of the xpcc uart (read, write, flushWriteBuffer,
+   isWriteFinished) used by the send- and recvbuffers.
+
+   RX: the DMA stream writes continuously into a circular buffer, the
+       write position is taken from the stream's NDTR register, hence
+       reading a byte is a plain memory access and no byte is lost while
+       the CPU is busy, as long as less than RxSize bytes are pending.
+   TX: data is copied into the transmit buffer and sent by the DMA stream,
+       the caller's buffer can be reused immediately. Transmission is
+       finished when the stream is done and the UART's TC flag is set,
+       i.e. the last stop bit has left the shift register.
+
+   The xpcc interrupt driven uart is not used at all, the USART is
+   configured directly (8N1). The only interrupts are the optional
+   transmit complete (TC) interrupt and the receive interrupt (RXNE),
+   which is used as one-shot wake-up only: the DMA takes the byte, the
+   handler disables the interrupt. The handler XPCC_ISR(USARTx) must be
+   provided by the application. */
+template <typename Uart, unsigned RxSize = 256, unsigned TxSize = 128>
+class DmaUart {
+	using traits = dma_uart_traits<Uart>;
+
+	static_assert((RxSize & (RxSize - 1)) == 0, "RX buffer size must be a power of 2.");
+	static_assert(RxSize <= 0xffff and TxSize <= 0xffff, "Buffer exceeds DMA transfer size.");
+
+public:
+	static constexpr unsigned tx_size = TxSize;
+
+private:
+	static uint8_t  rx_buffer[RxSize];
+	static uint8_t  tx_buffer[TxSize];
+	static uint16_t rx_tail;
+
+	/* interrupt flags of streams 0..3 are in LISR, 4..7 in HISR */
+	static constexpr uint32_t flag_shift(uint8_t num) {
+		return ((num & 3) == 0) ?  0
+		     : ((num & 3) == 1) ?  6
+		     : ((num & 3) == 2) ? 16 : 22;
+	}
+	static void clear_flags(uint8_t num) {
+		const uint32_t flags = 0x3D << flag_shift(num); /* TC, HT, TE, DME, FE */
+		if (num < 4) traits::dma()->LIFCR = flags;
+		else         traits::dma()->HIFCR = flags;
+	}
+
+	static uint16_t rx_head(void) { return RxSize - traits::rx_stream()->NDTR; }
+
+public:
+	template <typename SystemClock, unsigned baudrate>
+	static void initialize(void)
+	{
+		traits::enable_clocks();
+
+		USART_TypeDef* u = traits::usart();
+		u->CR1 = 0;
+		u->CR2 = 0;
+		u->CR3 = USART_CR3_DMAR | USART_CR3_DMAT;
+		u->BRR = (traits::template frequency<SystemClock>() + baudrate/2) / baudrate;
+		u->CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE;
+
+		/* RX: peripheral to memory, circular, high priority */
+		DMA_Stream_TypeDef* rx = traits::rx_stream();
+		rx->CR &= ~DMA_SxCR_EN;
+		while (rx->CR & DMA_SxCR_EN);
+		clear_flags(traits::rx_num);
+		rx->PAR  = (uint32_t) &u->DR;
+		rx->M0AR = (uint32_t) rx_buffer;
+		rx->NDTR = RxSize;
+		rx->FCR  = 0; /* direct mode */
+		rx->CR   = (traits::channel << 25) | DMA_SxCR_PL_1 | DMA_SxCR_MINC | DMA_SxCR_CIRC;
+		rx->CR  |= DMA_SxCR_EN;
+		rx_tail  = 0;
+
+		/* TX: memory to peripheral, configured once, started per write */
+		DMA_Stream_TypeDef* tx = traits::tx_stream();
+		tx->CR &= ~DMA_SxCR_EN;
+		while (tx->CR & DMA_SxCR_EN);
+		clear_flags(traits::tx_num);
+		tx->PAR  = (uint32_t) &u->DR;
+		tx->M0AR = (uint32_t) tx_buffer;
+		tx->FCR  = 0;
+		tx->CR   = (traits::channel << 25) | DMA_SxCR_PL_0 | DMA_SxCR_MINC | DMA_SxCR_DIR_0;
+	}
+
+	/* RX */
+	static bool read(uint8_t& data) {
+		if (rx_tail == rx_head()) return false;
+		data = rx_buffer[rx_tail];
+		rx_tail = (rx_tail + 1) & (RxSize - 1);
+		return true;
+	}
+
+	static uint16_t available(void) { return (rx_head() - rx_tail) & (RxSize - 1); }
+
+	static uint16_t discardReceiveBuffer(void) {
+		const uint16_t n = available();
+		rx_tail = rx_head();
+		return n;
+	}
+
+	/* TX */
+	static bool isWriteFinished(void) {
+		return not (traits::tx_stream()->CR & DMA_SxCR_EN)
+		       and (traits::usart()->SR & USART_SR_TC);
+	}
+
+	static void flushWriteBuffer(void) { while (not isWriteFinished()); }
+
+	/* returns the number of bytes sent, messages larger than TxSize are
+	   not sent at all (see writeDirect), senders check their size at
+	   compile time against tx_size */
+	static uint16_t write(const uint8_t* data, uint16_t length) {
+		flushWriteBuffer(); /* previous transfer must be completed */
+		if (length > TxSize) return 0;
+		for (uint16_t i = 0; i < length; ++i)
+			tx_buffer[i] = data[i];
+
+		DMA_Stream_TypeDef* tx = traits::tx_stream();
+		clear_flags(traits::tx_num);
+		traits::usart()->SR = ~USART_SR_TC; /* rc_w0 */
+		tx->M0AR = (uint32_t) tx_buffer;
+		tx->NDTR = length;
+		tx->CR  |= DMA_SxCR_EN;
+		return length;
+	}
+
+	static bool write(uint8_t data) { return write(&data, 1) == 1; }
+
+	/* zero-copy write, e.g. for frames larger than TxSize,
+	   data must remain unchanged until the write is finished */
+	static uint16_t writeDirect(const uint8_t* data, uint16_t length) {
+		flushWriteBuffer();
+		DMA_Stream_TypeDef* tx = traits::tx_stream();
+		clear_flags(traits::tx_num);
+		traits::usart()->SR = ~USART_SR_TC; /* rc_w0 */
+		tx->M0AR = (uint32_t) data;
+		tx->NDTR = length;
+		tx->CR  |= DMA_SxCR_EN;
+		return length;
+	}
+
+	/* TC and RXNE interrupts */
+	static void enableInterruptVector(uint32_t priority) {
+		NVIC_SetPriority(traits::irq, priority);
+		NVIC_EnableIRQ(traits::irq);
+	}
+	static void enableTransmitCompleteInterrupt (void) { traits::usart()->CR1 |=  USART_CR1_TCIE; }
+	static void disableTransmitCompleteInterrupt(void) { traits::usart()->CR1 &= ~USART_CR1_TCIE; }
+
+	/* TC interrupt enabled and transmission complete, i.e. the TC interrupt is pending */
+	static bool isTransmitComplete(void) {
+		return (traits::usart()->CR1 & USART_CR1_TCIE) and (traits::usart()->SR & USART_SR_TC);
+	}
+
+	static void enableReceiveInterrupt (void) { traits::usart()->CR1 |=  USART_CR1_RXNEIE; }
+	static void disableReceiveInterrupt(void) { traits::usart()->CR1 &= ~USART_CR1_RXNEIE; }
+	static bool isReceiveInterruptEnabled(void) { return traits::usart()->CR1 & USART_CR1_RXNEIE; }
+};
+
+template <typename Uart, unsigned RxSize, unsigned TxSize>
+uint8_t DmaUart<Uart, RxSize, TxSize>::rx_buffer[RxSize];
+
+template <typename Uart, unsigned RxSize, unsigned TxSize>
+uint8_t DmaUart<Uart, RxSize, TxSize>::tx_buffer[TxSize];
+
+template <typename Uart, unsigned RxSize, unsigned TxSize>
+uint16_t DmaUart<Uart, RxSize, TxSize>::rx_tail = 0;
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_DMA_UART_HPP */
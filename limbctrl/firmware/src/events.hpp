@@ -0,0 +1,39 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_EVENTS_HPP
+#define SUPREME_LIMBCTRL_EVENTS_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace supreme {
+
+/* Events posted by interrupts and taken by the main loop, one bit per
+   kind of event, i.e. events of the same kind are not counted but merged
+   until taken. Posting and taking are atomic read-modify-writes, hence
+   safe against preemption on both sides. The main loop must only sleep
+   if no event is pending, checked with interrupts masked. */
+class EventQueue {
+	std::atomic<uint32_t> pending;
+
+public:
+	EventQueue() : pending(0) {}
+
+	void post(uint32_t events) { pending.fetch_or(events, std::memory_order_relaxed); }
+
+	/* clears the given events, returns true if any of them was pending */
+	bool take(uint32_t events) {
+		return pending.fetch_and(~events, std::memory_order_relaxed) & events;
+	}
+
+	bool empty(void) const { return pending.load(std::memory_order_relaxed) == 0; }
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_EVENTS_HPP */
@@ -0,0 +1,133 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_FAULTS_HPP
+#define SUPREME_LIMBCTRL_FAULTS_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace supreme {
+
+/* Fault log, records the failed assertions (see common.cpp) with time,
+   state of the main loop and frame counter in a ring, the oldest
+   entries are overwritten. Each fault code has a policy:
+
+     proceed : the caller recovers by itself, e.g. a motor's receiver
+               restarts after an unknown response
+     reset   : the caller resets its subsystem, e.g. the transaction
+               with a motor, which is then treated as lost
+     halt    : continuing is unsafe (buffer bounds, invalid config),
+               the board stops and blinks the code
+
+   With the config flag 'halt', every fault halts (bench debugging).
+
+   The log is reported in the spinal cord slot (status byte, shared with
+   the sync diagnostics and the board health), as a record of 16 bytes,
+   byte i in frames with i = frame % 16 and 16 <= frame % 64 < 32:
+
+     [0,1]   number of faults since reset [MSB first, saturated]
+     [2]     number of subsystem resets [saturated]
+     [3..14] last 4 faults, latest first: code, state, frame
+     [15]    reserved (0)
+
+   The record is published at frame % 64 == 16, i.e. it stays
+   consistent while it is sent. */
+namespace faults {
+
+	enum Policy : uint8_t {
+		proceed = 0,
+		reset   = 1,
+		halt    = 2,
+	};
+
+	constexpr Policy policy(uint8_t code) {
+		switch (code) {
+			case  3: /* unknown motor response, */
+			case  4: /* restarts the receiver */
+			case 27:
+			case 55: return proceed;
+			case 17: /* motor receiver or transaction */
+			case 76: /* in unknown state */
+			case 78:
+			case 79: return reset;
+			default: return halt; /* buffer bounds, config, duplicate id */
+		}
+	}
+
+	constexpr unsigned record_bytes = 16;
+	constexpr unsigned num_reported = 4;
+
+	struct Fault {
+		uint32_t time;
+		uint8_t  code;
+		uint8_t  state;
+		uint8_t  frame;
+	};
+
+	template <unsigned N>
+	class Log {
+		static_assert((N & (N - 1)) == 0, "Number of entries must be a power of 2.");
+
+	public:
+		Log() : entries(), published() {}
+
+		/* halt on every fault, regardless of the code's policy */
+		void set_halt_all(bool h) { halt_all = h; }
+
+		/* context of following faults */
+		void set_state(uint8_t s) { state = s; }
+		void set_frame(uint8_t f) { frame = f; }
+
+		Policy record(uint8_t code, uint32_t time) {
+			entries[count & (N - 1)] = { time, code, state, frame };
+			++count;
+			const Policy p = halt_all ? halt : policy(code);
+			if (p == reset and resets < 255) ++resets;
+			return p;
+		}
+
+		/* number of recorded faults, latest first */
+		unsigned size (void) const { return (count < N) ? count : N; }
+		uint32_t get_count(void) const { return count; }
+		uint8_t  get_resets(void) const { return resets; }
+
+		Fault const& get(unsigned i) const { return entries[(count - 1 - i) & (N - 1)]; }
+
+		/* call once per frame */
+		void next_frame(uint8_t f) {
+			if (f % 64 != 16) return;
+			published.fill(0);
+			const uint16_t n = (count < 0xffff) ? count : 0xffff;
+			published[0] = n >> 8;
+			published[1] = n & 0xff;
+			published[2] = resets;
+			for (unsigned i = 0; i < num_reported and i < size(); ++i) {
+				published[3 + 3*i] = get(i).code;
+				published[4 + 3*i] = get(i).state;
+				published[5 + 3*i] = get(i).frame;
+			}
+		}
+
+		/* byte of the published record for the given frame */
+		uint8_t get_byte(uint8_t f) const { return published[f % record_bytes]; }
+
+	private:
+		std::array<Fault, N> entries;
+		std::array<uint8_t, record_bytes> published;
+		uint32_t count    = 0;
+		uint8_t  resets   = 0;
+		uint8_t  state    = 0;
+		uint8_t  frame    = 0;
+		bool     halt_all = false;
+	};
+
+} /* namespace faults */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_FAULTS_HPP */
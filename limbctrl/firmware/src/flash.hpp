@@ -0,0 +1,71 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_FLASH_HPP
+#define SUPREME_LIMBCTRL_FLASH_HPP
+
+#include <xpcc/architecture/platform.hpp>
+
+namespace supreme {
+
+/* One sector of the STM32F4's internal flash, programmed word-wise
+   (x32 parallelism, requires 2.7..3.6V). The core stalls while the
+   flash is busy, erasing a 128k sector takes 1..2 seconds. */
+template <uint8_t Sector, uint32_t Address, uint32_t Size>
+struct FlashSector {
+
+	static constexpr uint32_t size = Size;
+
+	static uint8_t const* data(void) { return reinterpret_cast<uint8_t const*>(Address); }
+
+	static bool erase(void) {
+		unlock();
+		FLASH->CR = FLASH_CR_PSIZE_1 | FLASH_CR_SER | (Sector << 3); /* SNB */
+		FLASH->CR |= FLASH_CR_STRT;
+		const bool result = wait();
+		FLASH->CR = 0;
+		lock();
+		return result;
+	}
+
+	static bool program(uint32_t offset, uint32_t word) {
+		if (offset + 4 > Size or (offset & 0x3)) return false;
+		unlock();
+		FLASH->CR = FLASH_CR_PSIZE_1 | FLASH_CR_PG;
+		*reinterpret_cast<volatile uint32_t*>(Address + offset) = word;
+		const bool result = wait();
+		FLASH->CR = 0;
+		lock();
+		return result;
+	}
+
+private:
+	static constexpr uint32_t errors = FLASH_SR_PGSERR | FLASH_SR_PGPERR | FLASH_SR_PGAERR | FLASH_SR_WRPERR;
+
+	static void unlock(void) {
+		while (FLASH->SR & FLASH_SR_BSY);
+		FLASH->SR = errors | FLASH_SR_EOP; /* clear pending flags */
+		if (FLASH->CR & FLASH_CR_LOCK) {
+			FLASH->KEYR = 0x45670123;
+			FLASH->KEYR = 0xCDEF89AB;
+		}
+	}
+
+	static void lock(void) { FLASH->CR |= FLASH_CR_LOCK; }
+
+	static bool wait(void) {
+		while (FLASH->SR & FLASH_SR_BSY);
+		return 0 == (FLASH->SR & errors);
+	}
+};
+
+/* sector 7 (last 128k of 512k), not used by the firmware image */
+using ConfigSector = FlashSector<7, 0x08060000, 0x20000>;
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_FLASH_HPP */
@@ -0,0 +1,151 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_HEALTH_HPP
+#define SUPREME_LIMBCTRL_HEALTH_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace supreme {
+
+/* Board health: supply and battery voltage, sampled by the ADC (see
+   adc_dma.hpp) and filtered once per frame (1/2^filter_shift), and the
+   battery status pin.
+
+   Under low supply voltage, the motors' pwm limit is derated to prevent
+   brown-outs: full limit down to full_mV, then linearly reduced to 1/4 at
+   min_mV and below. The limit is quantized to steps of 8 and is lowered
+   at once, but raised only when the supply exceeds the step's threshold
+   by hysteresis_mV, such that noise does not trigger a new setup of the
+   motors in every frame. Below absent_mV, the supply is considered not
+   measured (e.g. bench supply via USB), the limit is not derated.
+   The thresholds are part of the board config (see config.hpp).
+
+   The health is reported in the spinal cord slot (status byte, shared
+   with the sync diagnostics and the fault log), as a record of 16 bytes,
+   byte i in frames with i = frame % 16 and frame % 64 >= 48:
+
+     [0,1]   supply voltage [mV, MSB first]
+     [2,3]   battery voltage [mV]
+     [4,5]   min. supply voltage since the last record [mV]
+     [6]     battery status pin
+     [7]     pwm limit
+     [8..15] reserved (0)
+
+   The record is published at frame % 64 == 48. */
+namespace health {
+
+	constexpr uint8_t  filter_shift  = 2;
+	constexpr unsigned record_bytes  = 16;
+	constexpr uint16_t hysteresis_mV = 100; /* > one step of 8 with the default thresholds */
+
+	/* ADC reading [0..4095] to mV, given the input's full scale */
+	constexpr uint16_t to_mV(uint16_t raw, uint32_t full_scale_mV) {
+		return (uint32_t) raw * full_scale_mV / 4095;
+	}
+
+	struct Derating {
+		uint16_t full_mV;
+		uint16_t min_mV;
+		uint16_t absent_mV;
+	};
+
+	constexpr bool is_valid(Derating const& d) {
+		return d.absent_mV < d.min_mV and d.min_mV < d.full_mV and d.full_mV <= 0xffff - hysteresis_mV;
+	}
+
+	constexpr Derating raised(Derating const& d) {
+		return { (uint16_t) (d.full_mV + hysteresis_mV), (uint16_t) (d.min_mV + hysteresis_mV), d.absent_mV };
+	}
+
+	constexpr uint8_t derate(uint8_t limit, uint16_t supply_mV, Derating const& d) {
+		if (supply_mV < d.absent_mV or supply_mV >= d.full_mV or d.full_mV <= d.min_mV)
+			return limit;
+		const uint8_t lowest = limit / 4;
+		if (supply_mV <= d.min_mV)
+			return lowest;
+		const uint32_t l = lowest + (uint32_t) (limit - lowest) * (supply_mV - d.min_mV) / (d.full_mV - d.min_mV);
+		const uint8_t q = l & ~7u;
+		return (q > lowest) ? q : lowest;
+	}
+
+	class Monitor {
+	public:
+		Monitor(uint8_t max_limit, Derating const& derating)
+		: max_limit(max_limit), derating(derating), raising(raised(derating)), published(), limit(max_limit) {}
+
+		void set_derating(Derating const& d) {
+			derating = d;
+			raising  = raised(d);
+		}
+
+		/* call once per frame with the averaged readings [mV] */
+		void update(uint16_t supply_mV, uint16_t battery_mV, bool status) {
+			if (not valid) {
+				supply_acc  = (uint32_t) supply_mV  << filter_shift;
+				battery_acc = (uint32_t) battery_mV << filter_shift;
+				valid = true;
+			} else {
+				supply_acc  += supply_mV  - (supply_acc  >> filter_shift);
+				battery_acc += battery_mV - (battery_acc >> filter_shift);
+			}
+			if (get_supply_mV() < min_supply) min_supply = get_supply_mV();
+			battery_status = status;
+
+			const uint8_t lower = derate(max_limit, get_supply_mV(), derating);
+			const uint8_t upper = derate(max_limit, get_supply_mV(), raising);
+			if (lower < limit)
+				limit = lower;
+			else if (upper > limit)
+				limit = upper;
+		}
+
+		uint16_t get_supply_mV (void) const { return supply_acc  >> filter_shift; }
+		uint16_t get_battery_mV(void) const { return battery_acc >> filter_shift; }
+		bool     get_status    (void) const { return battery_status; }
+
+		uint8_t get_pwm_limit(void) const { return limit; }
+
+		/* call once per frame, publishes the record at frame % 64 == 48 */
+		void next_frame(uint8_t frame) {
+			if (frame % 64 != 48) return;
+			const uint16_t s = get_supply_mV(), b = get_battery_mV();
+			const uint16_t m = valid ? min_supply : 0;
+			published.fill(0);
+			published[0] = s >> 8;
+			published[1] = s & 0xff;
+			published[2] = b >> 8;
+			published[3] = b & 0xff;
+			published[4] = m >> 8;
+			published[5] = m & 0xff;
+			published[6] = battery_status;
+			published[7] = get_pwm_limit();
+			min_supply = 0xffff;
+		}
+
+		/* byte of the published record for the given frame */
+		uint8_t get_byte(uint8_t frame) const { return published[frame % record_bytes]; }
+
+	private:
+		const uint8_t  max_limit;
+		Derating       derating;
+		Derating       raising; /* thresholds to raise the limit */
+		std::array<uint8_t, record_bytes> published;
+		uint32_t supply_acc     = 0; /* << filter_shift */
+		uint32_t battery_acc    = 0;
+		uint16_t min_supply     = 0xffff;
+		uint8_t  limit;
+		bool     battery_status = false;
+		bool     valid          = false;
+	};
+
+} /* namespace health */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_HEALTH_HPP */
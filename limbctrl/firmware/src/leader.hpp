@@ -0,0 +1,54 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_LEADER_HPP
+#define SUPREME_LIMBCTRL_LEADER_HPP
+
+#include <cstdint>
+
+namespace supreme {
+
+/* lowest board id in a bit mask of boards, 0xff if empty */
+constexpr uint8_t lowest_id(uint8_t board_list) {
+	for (uint8_t b = 0; b < 8; ++b)
+		if (board_list & (1 << b)) return b;
+	return 0xff;
+}
+
+/* The leading board of a frame is the board with the lowest id of all
+   boards heard in the last frame, incl. this board. When the leader's
+   slot is over and was not received, the next lowest board takes over,
+   i.e. all boards agree on the new leader within the same frame, given
+   they heard the same boards in the last frame. */
+class LeaderElection {
+	const uint8_t own_id;
+	uint8_t candidates = 0;
+	uint8_t leader;
+
+public:
+	LeaderElection(uint8_t own_id) : own_id(own_id), leader(own_id) {}
+
+	/* start of frame, boards heard in the last frame */
+	void begin(uint8_t last_board_list) {
+		candidates = last_board_list | (1 << own_id);
+		leader = lowest_id(candidates);
+	}
+
+	/* leader's slot missed, returns the new leader */
+	uint8_t failover(void) {
+		if (leader != own_id)
+			candidates &= ~(1 << leader);
+		return leader = lowest_id(candidates);
+	}
+
+	uint8_t get_leader(void) const { return leader; }
+	bool    we_lead   (void) const { return leader == own_id; }
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_LEADER_HPP */
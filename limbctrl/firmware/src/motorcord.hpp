@@ -9,110 +9,193 @@
 #define SUPREME_LIMBCONTROLLER_MOTORCORD
 
 #include <src/ux_com.hpp>
+#include <src/cyclecounter.hpp>
+#include <src/topology.hpp>
+#include <src/setpoints.hpp>
 
 namespace supreme {
 
-	/*
-	formula: i/2 * 6 + i%2 + 2*j
-
-	id  |  motors
-	----+------------
-	 0  |  0,  2,  4
-	 1  |  1,  3,  5
-	 2  |  6,  8, 10
-	 3  |  7,  9, 11
-	(4) | 12, 14, 16
-	(5) | 13, 15, 17
-	*/
-
-constexpr
-uint8_t get_motor_id_from_board_id(uint8_t board_id, uint8_t motor_index) {
-	return board_id/2 * 6 + board_id%2 + 2*motor_index;
-}
-
-template <typename InterfaceType, typename TimerType, unsigned BoardID, unsigned NumMotors>
+/* Drives the sensorimotors of this board, the motor ids are taken
+   from the board's entry of the topology table (see topology.hpp). */
+template <typename InterfaceType, typename TimerType, unsigned NumVoltages>
 class MotorCord {
 
 	typedef supreme::ux_communication_ctrl<InterfaceType, TimerType> sensorimotor_t;
-	typedef std::array<sensorimotor_t,NumMotors> motorarray_t;
+	typedef std::array<sensorimotor_t, topology::max_motors_per_board> motorarray_t;
 
 public:
 
-	typedef std::array<scdata_t, 12> target_voltage_t;
+	typedef setpoints::Store<NumVoltages> Setpoints_t;
 
 	enum State_t {
 		ready = 0,
 		pending,
-		waiting_for_next,
 		done,
 	};
 
 
-	MotorCord(target_voltage_t& voltages) : voltages(voltages) {}
+	static const unsigned discovery_slot_us   = 3000; /* as in sensorimotor firmware */
+	static const uint8_t  max_discovery_count = 16;   /* as well, ids beyond are found by polling */
+	static const uint8_t  limit_pwm = 128; /* max., derated under low supply voltage, see health.hpp */
 
-	/* ping motors and setup */
+	MotorCord(Setpoints_t const& setpoints, topology::BoardEntry const& board)
+	: num_motors(board.num_motors)
+	, send_msg()
+	, setpoints(setpoints)
+	{
+		assert(num_motors <= motors.size(), 20);
+		for (uint8_t i = 0; i < num_motors; ++i) {
+			assert(board.motor_ids[i] < NumVoltages, 21);
+			motors[i] = sensorimotor_t(board.motor_ids[i]);
+		}
+	}
+
+	/* scan the bus for this board's motors with one discovery broadcast,
+	   the motors respond in consecutive slots ordered by id and are
+	   set up by one broadcast frame. Motors not found are polled with
+	   backoff later on and set up as soon as they respond. */
 	void initialize(volatile bool* is_timed_out)
 	{
-		for (auto& m: motors) {
-			unsigned trials = 0;
-			while(not m.ping_and_setup(is_timed_out)) {
-				++trials;
-				if (trials >= 1000) assert(false, 0xFF);
-			}
+		if (num_motors == 0) return;
+
+		uint8_t first = motors[0].get_id(), last = first;
+		for (uint8_t i = 1; i < num_motors; ++i) {
+			if (motors[i].get_id() < first) first = motors[i].get_id();
+			if (motors[i].get_id() > last ) last  = motors[i].get_id();
 		}
+		const uint8_t count = std::min<uint8_t>(last - first + 1, max_discovery_count);
+
+		send_msg.add_byte(0xE2);
+		send_msg.add_byte(first);
+		send_msg.add_byte(count);
+		send_msg.transmit();
 
+		*is_timed_out = false;
+		TimerType::template setPeriod<Board::systemClock>(count * discovery_slot_us + sensorimotor_t::motor_timeout_us);
+		reset_and_start_timer<TimerType>();
+		while (not *is_timed_out)
+			collect_discovery_responses();
+		*is_timed_out = false;
+
+		send_setup();
 	}
 
 	void prepare(void) {
-		for (auto& m: motors) {
-			if (m.get_id() < 12)
-				m.set_target_voltage(voltages[m.get_id()]);
-			else
-				m.set_target_voltage(0);
-		}
+		auto const& voltages = setpoints.get(); /* snapshot */
+		for (uint8_t i = 0; i < num_motors; ++i)
+			motors[i].set_target_voltage(voltages[motors[i].get_id()]);
 		idx = 0;
 		state = ready;
-		voltages.fill(0); // clear target voltages;
+		started = cyclecounter::now();
 	}
 
 	/* after preparing motor commands,
 	   transmit() must be called multiple times,
-	   until <done> */
+	   until <done>. Motors are polled pipelined, i.e.
+	   as soon as one transaction is completed (response
+	   received or timed out) the next request is sent. */
 	State_t transmit(volatile bool* is_timed_out)
 	{
-		if (idx < NumMotors)
-		{
-			if (motors[idx].step(is_timed_out)) {
-				++idx; state = waiting_for_next;
-			} else state = pending;
-		}
-		else if (idx < 2*NumMotors)
+		if (state == done) return state;
+
+		while (idx < num_motors)
 		{
-			if (motors[idx%NumMotors].read_ext_sensor(is_timed_out)) {
-				++idx; state = waiting_for_next;
-			} else state = pending;
-		}
-		else {
-			assert(idx == 2*NumMotors, 12);
-			state = done;
+			if (not motors[idx].update(is_timed_out))
+				return state = pending;
+			*is_timed_out = false; /* consumed by this motor */
+			++idx;
 		}
 
-		return state;
+		/* set up motors which (re-)connected in this cycle, or all for a new pwm limit */
+		bool setup = limit_changed;
+		for (uint8_t i = 0; i < num_motors; ++i)
+			if (motors[i].needs_setup()) setup = true;
+		if (setup)
+			send_setup();
+
+		duration = cyclecounter::elapsed(started);
+		return state = done;
+	}
+
+	/* pwm limit of all motors, applied by a setup broadcast
+	   at the end of the next motorcord phase */
+	void set_pwm_limit(uint8_t limit) {
+		if (limit > limit_pwm) limit = limit_pwm;
+		if (limit == pwm_limit) return;
+		pwm_limit = limit;
+		limit_changed = true;
 	}
 
+	uint8_t get_pwm_limit(void) const { return pwm_limit; }
+
+	/* motors reading an external sensor prefetch it every n-th tick
+	   of their 1kHz loop and stamp the samples with the tick, such
+	   that sample times are known. Sent with the setup, 0: off */
+	void set_ext_sensor_prefetch(uint8_t divider) { prefetch_divider = divider; }
+
+	/* duration of the last completed motorcord phase */
+	uint32_t get_cycle_time_us(void) const { return cyclecounter::to_us(duration); }
+
 	motorarray_t const& get_motors(void) const { return motors; }
 	motorarray_t &      set_motors(void)       { return motors; }
+	uint8_t         get_num_motors(void) const { return num_motors; }
 
 private:
 
+	/* broadcast setup, applied by all motors on the bus */
+	void send_setup(void) {
+		send_msg.add_byte(0xA1);
+		send_msg.add_byte(0x7F); /* don't care */
+		send_msg.add_byte(pwm_limit);
+		send_msg.transmit();
+		limit_changed = false;
+		for (uint8_t i = 0; i < num_motors; ++i) {
+			if (not motors[i].needs_setup()) continue;
+			if (motors[i].reads_ext_sensor())
+				send_prefetch(motors[i].get_id());
+			motors[i].setup_done();
+		}
+	}
+
+	void send_prefetch(uint8_t id) {
+		send_msg.add_byte(0x50);
+		send_msg.add_byte(id);
+		send_msg.add_byte(prefetch_divider);
+		send_msg.transmit();
+	}
+
+	/* find ping responses (0xE1) in the byte stream */
+	void collect_discovery_responses(void) {
+		uint8_t byte;
+		while (InterfaceType::uart::read(byte)) {
+			for (unsigned i = 0; i + 1 < window.size(); ++i)
+				window[i] = window[i+1];
+			window.back() = byte;
+
+			const uint8_t checksum = window[0] + window[1] + window[2] + window[3] + window[4];
+			if (window[0] == 0xFF and window[1] == 0xFF and window[2] == 0xE1 and checksum == 0)
+				for (uint8_t i = 0; i < num_motors; ++i)
+					if (motors[i].get_id() == window[3]) motors[i].set_discovered();
+		}
+	}
+
 	unsigned idx = 0;
 	State_t state = done; // prepare_motor_commands() must be called first
 
-	motorarray_t motors = { get_motor_id_from_board_id(BoardID, 0)
-	                      , get_motor_id_from_board_id(BoardID, 1)
-	                      , get_motor_id_from_board_id(BoardID, 2) };
+	uint32_t started  = 0;
+	uint32_t duration = 0;
+
+	uint8_t pwm_limit     = limit_pwm;
+	bool    limit_changed = false;
+	uint8_t prefetch_divider = 0;
+
+	motorarray_t motors;
+	uint8_t      num_motors;
+
+	sendbuffer<InterfaceType, 8, 0xFF> send_msg;
+	std::array<uint8_t, 5>             window = {{0,0,0,0,0}};
 
-	target_voltage_t& voltages;
+	Setpoints_t const& setpoints;
 
 }; /* class MotorCord */
 
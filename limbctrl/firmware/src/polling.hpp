@@ -0,0 +1,87 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_POLLING_HPP
+#define SUPREME_LIMBCTRL_POLLING_HPP
+
+namespace supreme {
+
+/* Response latency of a motor in us, tracked as min, max and
+   exponentially weighted moving average (alpha = 1/16).
+
+   The response timeout is derived as max + margin, the margin is the
+   observed spread (max - min), but at least min_margin. The default
+   timeout is used until min_samples latencies were measured, and for
+   the next request after a timeout, such that a single late response
+   is caught and adds to the statistics. A timeout does not discard the
+   statistics. */
+class LatencyStats {
+	uint16_t min_us = 0xffff;
+	uint16_t max_us = 0;
+	uint32_t avg_q4 = 0; /* EWMA, Q4 */
+	uint16_t samples = 0;
+	bool     missed  = false;
+
+public:
+	static constexpr uint16_t min_samples = 16;
+
+	void add(uint16_t us) {
+		if (us < min_us) min_us = us;
+		if (us > max_us) max_us = us;
+		if (samples == 0) avg_q4 = (uint32_t) us << 4;
+		else              avg_q4 = avg_q4 + us - (avg_q4 >> 4);
+		if (samples < 0xffff) ++samples;
+		missed = false;
+	}
+
+	/* the last request timed out */
+	void timed_out(void) { missed = true; }
+
+	uint16_t get_min(void) const { return samples ? min_us : 0; }
+	uint16_t get_max(void) const { return max_us; }
+	uint16_t get_avg(void) const { return avg_q4 >> 4; }
+	uint16_t get_samples(void) const { return samples; }
+
+	uint16_t get_timeout(uint16_t min_margin, uint16_t default_us) const {
+		if (samples < min_samples or missed) return default_us;
+		const uint16_t spread = max_us - min_us;
+		const uint32_t t = (uint32_t) max_us + ((spread > min_margin) ? spread : min_margin);
+		return (t < default_us) ? t : default_us;
+	}
+};
+
+/* Exponential backoff for polling unresponsive motors,
+   after the n-th failed attempt in a row, the next 2^n - 1
+   polls are skipped (n is limited to MaxExponent). */
+template <uint8_t MaxExponent = 6>
+class Backoff {
+	uint8_t exponent  = 0;
+	uint8_t countdown = 0;
+
+	static_assert(MaxExponent < 8, "Backoff exceeds countdown range.");
+
+public:
+	/* call once per poll cycle */
+	bool poll_now(void) {
+		if (countdown == 0) return true;
+		--countdown;
+		return false;
+	}
+
+	void failed(void) {
+		if (exponent < MaxExponent) ++exponent;
+		countdown = (1 << exponent) - 1;
+	}
+
+	void succeeded(void) { exponent = 0; countdown = 0; }
+
+	uint8_t get_exponent(void) const { return exponent; }
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_POLLING_HPP */
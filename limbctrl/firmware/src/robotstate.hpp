@@ -0,0 +1,94 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_ROBOTSTATE_HPP
+#define SUPREME_LIMBCTRL_ROBOTSTATE_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace supreme {
+
+/* Aggregated robot state frame, assembled by the trunk controller from
+   all slots of one spinal cord frame and sent to the host in one burst:
+
+     [0,1] sync bytes
+     [2]   id 0xFD
+     [3,4] length of the frame, incl. sync and checksum, MSB first
+     [5]   frame counter
+     [6]   validity bitmap, bit i set if the slot of board i is included
+     [7]   number of slots
+     [8..] slots in order of reception, each as sent on the spinal cord
+           (full format, with sync, id, length and checksum)
+     [n-1] checksum of the whole frame
+
+   A board's slot is included once per frame, later duplicates are dropped. */
+template <unsigned MaxBoards, unsigned BytesPerSlot, uint8_t SyncByte = 0x55>
+class RobotState {
+public:
+	static constexpr uint8_t  frame_id     = 0xFD;
+	static constexpr unsigned header_bytes = 8;
+	static constexpr unsigned max_bytes    = header_bytes + MaxBoards * BytesPerSlot + 1;
+
+	static_assert(MaxBoards <= 8, "Validity bitmap holds 8 boards only.");
+	static_assert(max_bytes <= 0xffff, "Frame exceeds length field.");
+
+	RobotState() : buffer() {}
+
+	void begin(uint8_t frame) {
+		buffer[0] = SyncByte;
+		buffer[1] = SyncByte;
+		buffer[2] = frame_id;
+		buffer[5] = frame;
+		buffer[6] = 0;
+		buffer[7] = 0;
+		length = header_bytes;
+		open = true;
+	}
+
+	/* adds a slot, board id is taken from the slot */
+	template <typename Buffer_t>
+	bool add(Buffer_t const& slot, unsigned slot_length) {
+		if (not open or slot_length < 4 or slot_length > BytesPerSlot) return false;
+		const uint8_t board = slot[2];
+		if (board >= MaxBoards or (buffer[6] & (1 << board))) return false;
+
+		for (unsigned i = 0; i < slot_length; ++i)
+			buffer[length + i] = slot[i];
+		length += slot_length;
+		buffer[6] |= 1 << board;
+		++buffer[7];
+		return true;
+	}
+
+	/* completes the frame, no more slots are accepted until next begin() */
+	void finish(void) {
+		const unsigned total = length + 1;
+		buffer[3] = total >> 8;
+		buffer[4] = total & 0xff;
+		uint8_t sum = 0;
+		for (unsigned i = 0; i < length; ++i)
+			sum += buffer[i];
+		buffer[length++] = ~sum + 1; /* two's complement checksum */
+		open = false;
+	}
+
+	bool is_open(void) const { return open; }
+
+	uint8_t const* get       (void) const { return buffer.data(); }
+	unsigned       get_length(void) const { return length; }
+	uint8_t        get_valid (void) const { return buffer[6]; }
+
+private:
+	std::array<uint8_t, max_bytes> buffer;
+	unsigned length = 0;
+	bool     open   = false;
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_ROBOTSTATE_HPP */
@@ -0,0 +1,111 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_SETPOINTS_HPP
+#define SUPREME_LIMBCTRL_SETPOINTS_HPP
+
+#include <array>
+#include <cstdint>
+#include <src/math.hpp>
+
+namespace supreme {
+
+/* Double-buffered store of the target voltages.
+
+   Writers (transparent data, local controller) fill the back buffer
+   and commit it as a whole, the motor cord only reads the front
+   buffer, i.e. always one consistent snapshot. Every commit marks the
+   setpoints fresh, when no commit arrives, the policy is applied at
+   the start of each frame:
+
+     zero : setpoints are cleared after hold_frames frames
+     hold : last setpoints are kept
+     decay: after hold_frames frames, setpoints are reduced by
+            1/2^decay_shift of their magnitude each frame
+
+   Setpoints are used in the frame they were committed, hence zero
+   with hold_frames = 0 clears them after one use. */
+namespace setpoints {
+
+	enum Mode : uint8_t {
+		zero = 0,
+		hold,
+		decay,
+	};
+
+	struct Policy {
+		Mode    mode;
+		uint8_t hold_frames;
+		uint8_t decay_shift;
+	};
+
+	/* scales the magnitude of spinalcord data, keeps the sign (see math.hpp) */
+	constexpr scdata_t decayed(scdata_t s, uint8_t shift) {
+		return ((s & 0x7FFF) >> shift == 0)
+		     ? 0
+		     : (s & 0x8000) | ((s & 0x7FFF) - ((s & 0x7FFF) >> shift));
+	}
+
+	template <unsigned NumVoltages>
+	class Store {
+	public:
+		typedef std::array<scdata_t, NumVoltages> Values_t;
+
+		static constexpr uint8_t max_age = 255;
+
+		Store(Policy const& policy)
+		: policy(policy)
+		, buffers()
+		{}
+
+		/* returns the back buffer, initialized with the current setpoints */
+		Values_t& begin_write(void) {
+			buffers[1 - front] = buffers[front];
+			return buffers[1 - front];
+		}
+
+		/* makes the back buffer the current setpoints */
+		void commit(void) {
+			front = 1 - front;
+			age = 0;
+			fresh_since = frame;
+		}
+
+		/* call once per frame, before writers commit */
+		void next_frame(uint8_t frame_number) {
+			frame = frame_number;
+			if (age < max_age) ++age;
+			if (age <= policy.hold_frames) return;
+
+			Values_t& v = buffers[front];
+			switch (policy.mode) {
+				case zero : v.fill(0); break;
+				case hold : break;
+				case decay: for (auto& s: v) s = decayed(s, policy.decay_shift); break;
+			}
+		}
+
+		Values_t const& get(void) const { return buffers[front]; }
+
+		bool    is_fresh       (void) const { return age == 0; }
+		uint8_t get_age        (void) const { return age; } /* frames since last commit, saturating */
+		uint8_t get_fresh_since(void) const { return fresh_since; } /* frame of last commit */
+
+	private:
+		Policy const policy;
+		std::array<Values_t, 2> buffers;
+		uint8_t front       = 0;
+		uint8_t age         = max_age;
+		uint8_t frame       = 0;
+		uint8_t fresh_since = 0;
+	};
+
+} /* namespace setpoints */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_SETPOINTS_HPP */
@@ -0,0 +1,67 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_SLOTQUEUE_HPP
+#define SUPREME_LIMBCTRL_SLOTQUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace supreme {
+
+/* Ring of slots with one producer (main loop) and one consumer
+   (interrupt), no locking: the producer only writes head, the
+   consumer only writes tail. A slot is copied before it is published
+   by advancing head. When the queue is full, the new slot is dropped. */
+template <unsigned SlotBytes, unsigned NumSlots>
+class SlotQueue {
+	static_assert((NumSlots & (NumSlots - 1)) == 0, "Number of slots must be a power of 2.");
+	static_assert(NumSlots < 256, "Too many slots.");
+	static_assert(SlotBytes <= 0xffff, "Slot exceeds length field.");
+
+	std::array<std::array<uint8_t, SlotBytes>, NumSlots> slots;
+	std::array<uint16_t, NumSlots> lengths;
+
+	volatile uint8_t head = 0; /* next slot to write */
+	volatile uint8_t tail = 0; /* next slot to read */
+
+	static uint8_t next(uint8_t i) { return (i + 1) & (NumSlots - 1); }
+
+public:
+	SlotQueue() : slots(), lengths() {}
+
+	bool empty(void) const { return head == tail; }
+	bool full (void) const { return next(head) == tail; }
+
+	uint8_t size(void) const { return (head - tail) & (NumSlots - 1); }
+
+	/* producer */
+	bool push(uint8_t const* data, unsigned length) {
+		if (full() or length > SlotBytes) return false;
+		const uint8_t h = head;
+		for (unsigned i = 0; i < length; ++i)
+			slots[h][i] = data[i];
+		lengths[h] = length;
+		std::atomic_signal_fence(std::memory_order_release);
+		head = next(h);
+		return true;
+	}
+
+	/* consumer, front() is valid until pop() */
+	uint8_t const* front       (void) const { return slots[tail].data(); }
+	uint16_t       front_length(void) const { return lengths[tail]; }
+
+	void pop(void) {
+		std::atomic_signal_fence(std::memory_order_acquire);
+		if (not empty()) tail = next(tail);
+	}
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_SLOTQUEUE_HPP */
@@ -0,0 +1,242 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_SLOTTABLE_HPP
+#define SUPREME_LIMBCTRL_SLOTTABLE_HPP
+
+#include <array>
+#include <cstdint>
+#include <src/topology.hpp>
+#include <src/telemetry.hpp>
+
+namespace supreme {
+
+/* TDMA slot table of the spinal cord: frame rate, order and length of the
+   boards' slots and the start of the motor phase. The table is loaded at
+   boot and distributed by the leading board, 2 bytes per frame, in the
+   last bytes of its slot. Followers adopt a changed table at the end of
+   the frame, so all boards recompute their timing at the same frame
+   boundary (give or take the frames needed for the transfer). */
+namespace slottable {
+
+	constexpr uint8_t max_slots   = topology::max_boards;
+	constexpr uint8_t chunk_bytes = 4; /* tag, index, 2 bytes of table */
+
+	typedef std::array<uint8_t, chunk_bytes> Chunk;
+
+	struct Table {
+		uint8_t revision;    /* incremented with every change */
+		uint8_t frame_100us; /* frame time in 100us, 100 = 100Hz, 20 = 500Hz */
+		uint8_t motor_100us; /* start of motor phase after frame start */
+		uint8_t num_slots;
+		uint8_t slots[max_slots]; /* in slot order, see slot_entry() */
+	};
+
+	static_assert(sizeof(Table) == 12, "Table must be packed.");
+
+	constexpr uint8_t num_chunks = sizeof(Table) / 2;
+
+	/* slot entry: board id (bits 0..2) and slot length in multiples of 8 bytes (bits 3..7) */
+	constexpr uint8_t  slot_entry(uint8_t board_id, unsigned bytes) { return (bytes / 8) << 3 | (board_id & 0x7); }
+	constexpr uint8_t  board_of  (uint8_t entry) { return entry & 0x7; }
+	constexpr unsigned bytes_of  (uint8_t entry) { return (entry >> 3) * 8u; }
+
+	/* all boards in order of their id, with same slot length */
+	constexpr Table make_uniform(uint8_t frame_100us, uint8_t motor_100us, uint8_t num_slots, unsigned bytes) {
+		Table t = { 0, frame_100us, motor_100us, num_slots, {0,0,0,0,0,0,0,0} };
+		for (uint8_t i = 0; i < num_slots and i < max_slots; ++i)
+			t.slots[i] = slot_entry(i, bytes);
+		return t;
+	}
+
+	/* max. slot size of a board, full or compact telemetry */
+	constexpr unsigned board_slot_bytes(uint8_t num_motors, bool compact) {
+		return compact ? telemetry::compact_slot_bytes(num_motors) : topology::slot_bytes(num_motors);
+	}
+
+	/* all boards of a topology in order of their id,
+	   with slot lengths fitted to their number of motors */
+	constexpr Table make_fitted(uint8_t frame_100us, uint8_t motor_100us, topology::Table const& topo, bool compact = false) {
+		Table t = { 0, frame_100us, motor_100us, topo.num_boards, {0,0,0,0,0,0,0,0} };
+		for (uint8_t i = 0; i < topo.num_boards and i < max_slots; ++i)
+			t.slots[i] = slot_entry(i, (board_slot_bytes(topo.boards[i].num_motors, compact) + 7) / 8 * 8);
+		return t;
+	}
+
+	/* each board's slot must hold the board's data */
+	constexpr bool fits(Table const& t, topology::Table const& topo, bool compact = false) {
+		for (uint8_t i = 0; i < t.num_slots and i < max_slots; ++i) {
+			const uint8_t b = board_of(t.slots[i]);
+			if (b < topo.num_boards and bytes_of(t.slots[i]) < board_slot_bytes(topo.boards[b].num_motors, compact))
+				return false;
+		}
+		return true;
+	}
+
+	inline uint8_t crc8(Table const& t) {
+		uint8_t const* p = reinterpret_cast<uint8_t const*>(&t);
+		uint8_t crc = 0;
+		for (unsigned i = 0; i < sizeof(Table); ++i) {
+			crc ^= p[i];
+			for (uint8_t b = 0; b < 8; ++b)
+				crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+		}
+		return crc;
+	}
+
+	inline bool operator==(Table const& a, Table const& b) {
+		uint8_t const* p = reinterpret_cast<uint8_t const*>(&a);
+		uint8_t const* q = reinterpret_cast<uint8_t const*>(&b);
+		for (unsigned i = 0; i < sizeof(Table); ++i)
+			if (p[i] != q[i]) return false;
+		return true;
+	}
+
+	/* Computes the frame timing of a slot table. The slot length includes
+	   the transmission of its bytes and the deadtime between two slots.
+	   MinSlotBytes is the size of the shortest slot. */
+	template <unsigned ByteTime_us, unsigned Deadtime_us, unsigned MinSlotBytes>
+	class Schedule {
+	public:
+
+		static constexpr unsigned slot_us(uint8_t entry) { return bytes_of(entry) * ByteTime_us + Deadtime_us; }
+
+		/* duration of all slots, the motor phase must not start before */
+		static constexpr unsigned comm_us(Table const& t) {
+			unsigned sum = Deadtime_us;
+			for (uint8_t i = 0; i < t.num_slots and i < max_slots; ++i)
+				sum += slot_us(t.slots[i]);
+			return sum;
+		}
+
+		static constexpr bool is_valid(Table const& t) {
+			if (t.num_slots == 0 or t.num_slots > max_slots) return false;
+			uint8_t used = 0; /* bit mask of board ids */
+			for (uint8_t i = 0; i < t.num_slots; ++i) {
+				const uint8_t b = board_of(t.slots[i]);
+				if (used & (1 << b)) return false; /* not unique */
+				used |= 1 << b;
+				if (bytes_of(t.slots[i]) < MinSlotBytes) return false;
+			}
+			return comm_us(t) <= t.motor_100us * 100u
+			   and t.motor_100us < t.frame_100us;
+		}
+
+		/* applies a table, returns false if the table was rejected */
+		bool load(Table const& t, uint8_t board_id) {
+			if (not is_valid(t)) return false;
+			active = t;
+			pending = false;
+
+			frametime = t.frame_100us * 100u;
+			motortime = t.motor_100us * 100u;
+			has_slot  = false;
+			offsets.fill(0);
+			ends.fill(0);
+			unsigned offset = 0;
+			for (uint8_t i = 0; i < t.num_slots; ++i) {
+				const uint8_t b = board_of(t.slots[i]);
+				offsets[b] = offset;
+				if (b == board_id) has_slot = true;
+				offset += slot_us(t.slots[i]);
+				ends[b] = offset;
+			}
+			local_delay = offsets[board_id] + Deadtime_us;
+			comm = comm_us(t);
+			return true;
+		}
+
+		/* tables received from the leading board must give each board
+		   of this topology enough room for its data, see fits() */
+		void set_topology(topology::Table const& t, bool compact_slots) {
+			topo = &t;
+			compact = compact_slots;
+		}
+
+		/* applies a table received from the leading board, to be called
+		   at the end of a frame. Returns true if the timing changed. */
+		bool update(uint8_t board_id) {
+			if (not pending) return false;
+			return load(pending_table, board_id);
+		}
+
+		Table const& get_table(void) const { return active; }
+
+		/* frame timing in us */
+		unsigned get_frametime_us  (void) const { return frametime; }
+		unsigned get_motortime_us  (void) const { return motortime; }
+		unsigned get_local_delay_us(void) const { return local_delay; }
+		unsigned get_comm_us       (void) const { return comm; }
+		unsigned get_slot_start_us (uint8_t b) const { return offsets[b & 0x7] + Deadtime_us; }
+		unsigned get_slot_end_us   (uint8_t b) const { return ends[b & 0x7]; } /* 0 if no slot */
+		bool     has_own_slot      (void) const { return has_slot; }
+
+		/* period of the global sync timer, when synchronizing to the
+		   start of the slot of board <ref_id> */
+		unsigned get_sync_us(uint8_t ref_id) const { return frametime - offsets[ref_id & 0x7]; }
+
+		/* part of the table to be sent in the own slot of the given frame */
+		Chunk get_chunk(uint8_t frame) const {
+			const uint8_t idx = frame % num_chunks;
+			uint8_t const* p = reinterpret_cast<uint8_t const*>(&active);
+			return {{ crc8(active), idx, p[2*idx], p[2*idx+1] }};
+		}
+
+		/* collects the table chunks from the leading board's slot of
+		   given length, a complete table is applied with the next update() */
+		template <typename Buffer_t>
+		void receive_slot(Buffer_t const& slot, unsigned length) {
+			if (length < chunk_bytes + 1 or length > slot.size()) return;
+			const unsigned pos = length - 1 - chunk_bytes; /* before checksum */
+			const uint8_t tag = slot[pos];
+			const uint8_t idx = slot[pos+1];
+			if (idx >= num_chunks) return;
+
+			if (tag != received_tag) { /* new table, start over */
+				received_tag = tag;
+				received_mask = 0;
+			}
+			uint8_t* p = reinterpret_cast<uint8_t*>(&received);
+			p[2*idx  ] = slot[pos+2];
+			p[2*idx+1] = slot[pos+3];
+			received_mask |= 1 << idx;
+
+			if (received_mask == (1 << num_chunks) - 1) {
+				received_mask = 0;
+				if (crc8(received) == tag and not (received == active) and is_valid(received)
+				    and (topo == nullptr or fits(received, *topo, compact))) {
+					pending_table = received;
+					pending = true;
+				}
+			}
+		}
+
+	private:
+		Table    active      = {};
+		unsigned frametime   = 0;
+		unsigned motortime   = 0;
+		unsigned local_delay = 0;
+		unsigned comm        = 0;
+		bool     has_slot    = false;
+		std::array<unsigned, max_slots> offsets = {};
+		std::array<unsigned, max_slots> ends    = {};
+
+		Table    received      = {};
+		Table    pending_table = {};
+		uint8_t  received_tag  = 0;
+		uint8_t  received_mask = 0;
+		bool     pending       = false;
+
+		topology::Table const* topo = nullptr;
+		bool     compact       = false;
+	};
+
+} /* namespace slottable */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_SLOTTABLE_HPP */
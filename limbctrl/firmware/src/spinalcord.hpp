@@ -11,97 +11,162 @@
 #include <xpcc/architecture/platform.hpp>
 #include <src/transceivebuffer.hpp>
 #include <src/transparent_data.hpp>
+#include <src/slottable.hpp>
+#include <src/telemetry.hpp>
+#include <src/slotqueue.hpp>
 
 using namespace Board;
 
 namespace supreme {
 
 
-template <typename Interface, uint8_t BufferSize, uint8_t SyncByte, typename Motorcord_t, unsigned BoardID>
+template <typename Interface, uint8_t BufferSize, uint8_t SyncByte, typename Motorcord_t>
 class SpinalCord : public sendbuffer<Interface, BufferSize, SyncByte> {
 
 	Motorcord_t const& motorcord;
+	const uint8_t      board_id;
+	const bool         compact;
+	uint8_t            length = 0;
+
+	telemetry::Encoder<topology::max_motors_per_board> encoder;
 
 public:
 
-	SpinalCord(Motorcord_t const& motorcord)
+	SpinalCord(Motorcord_t const& motorcord, uint8_t board_id, bool compact = false)
 	: sendbuffer<Interface, BufferSize, SyncByte>()
 	, motorcord(motorcord)
+	, board_id(board_id)
+	, compact(compact)
+	, encoder()
 	{}
 
 	void prepare(uint8_t min_id,
-	             uint8_t last_min_id,
+	             uint8_t status,
 	             uint8_t board_list,
 	             uint8_t packets,
 	             uint8_t errors,
-	             uint8_t cycles)
+	             uint8_t cycles,
+	             slottable::Chunk const& table_chunk)
 	{
-		this->add_byte(BoardID);
+		const uint8_t num_motors = motorcord.get_num_motors();
+		length = compact ? telemetry::compact_slot_bytes(num_motors, cycles)
+		                 : topology::slot_bytes(num_motors);
+		assert(length <= BufferSize, 19);
+
+		this->add_byte(board_id);
+		this->add_byte(length);
 
-		/*temporary testing data*/
 		this->add_byte(min_id);
-		this->add_byte(last_min_id);
+		this->add_byte(status); /* one byte of a status record, see syncdiag.hpp, faults.hpp, health.hpp */
 		this->add_byte(board_list);
 		this->add_byte(packets);
 		this->add_byte(errors);
 		this->add_byte(cycles);
-		this->add_byte(0);
+		{   /* duration of the motorcord phase in 10us, saturated */
+			const uint32_t t = motorcord.get_cycle_time_us() / 10;
+			this->add_byte(t < 255 ? t : 255);
+		}
 
+		this->add_byte(num_motors | (compact ? telemetry::compact_flag : 0));
 		auto const& motors = motorcord.get_motors();
-		for (auto const& m: motors) {
-			this->add_byte(m.get_id());
-			this->add_byte(m.get_connection_status());
+		for (uint8_t i = 0; i < num_motors; ++i) {
+			auto const& m = motors[i];
 			auto const& s = m.get_status_data();
-			this->add_word(s.position);
-			this->add_word(s.current);
-			this->add_word(s.velocity);
-			this->add_word(s.voltage_supply);
-			this->add_word(s.temperature);
-			//TODO add voltage_backemf and target voltage readback
+			const telemetry::Sample sample = {{ s.position
+			                                  , s.current
+			                                  , s.velocity
+			                                  , s.voltage_supply
+			                                  , s.temperature
+			                                  , s.ext_sensor[0] /* external sensor's data */
+			                                  , s.ext_sensor[1]
+			                                  , s.ext_sensor[2]
+			                                  , s.ext_sensor_timestamp
+			                                  , (uint16_t) (s.position_multiturn >> 16)
+			                                  , (uint16_t) s.position_multiturn
+			                                  , s.voltage_back_emf
+			                                  , s.velocity_fused
+			                                  , (uint16_t) s.position_calibrated }};
+			if (compact)
+				encoder.encode(*this, cycles, i, m.get_id(), m.get_connection_status(), sample);
+			else {
+				this->add_byte(m.get_id());
+				this->add_byte(m.get_connection_status());
+				for (auto const& v: sample)
+					this->add_word(v);
+			}
 		}
 
-		/* add external sensor's data
-		   TODO: increase slot buffer size and transmit for each motor.
-		 */
-		auto const& s = motors[0].get_status_data();
-		this->add_word(s.ext_sensor[0]);
-		this->add_word(s.ext_sensor[1]);
-		this->add_word(s.ext_sensor[2]);
-
-		/* fill reserved */
-		for (unsigned i = this->size(); i < BufferSize-1; ++i)
-			this->add_byte(0xEE);
+		/* slot table, last bytes before checksum */
+		for (auto const& b: table_chunk)
+			this->add_byte(b);
 		/* checksum is added automagically */
-		assert(this->size() == BufferSize-1,19);
+		assert(this->size() == length-1u, 19);
 	}
 
+	/* length of the last prepared slot, incl. sync bytes and checksum */
+	uint8_t get_length(void) const { return length; }
+
 };
 
-template <typename Interface>
+/* Forwards slots or robot state frames (see robotstate.hpp) to the
+   external port (trunk controller only). Frames are queued and sent by
+   the UART's transmit complete interrupt, directly from the queue,
+   hence forwarding never blocks the spinal cord. The transceiver stays
+   in send mode until the queue is drained. */
+template <typename Interface, unsigned MaxBytes, unsigned QueueSize = 8>
 class SpinalCordFull {
 
-	bool transmission_pending = false;
+	SlotQueue<MaxBytes, QueueSize> queue;
+
+	volatile bool     sending   = false;
+	volatile bool     in_flight = false; /* front of queue is being sent */
+	volatile uint16_t dropped   = 0;
 
 public:
 
+	SpinalCordFull() : queue() {}
+
+	void initialize(uint32_t priority) { Interface::uart::enableInterruptVector(priority); }
+
 	template <typename Buffer_t>
-	void start_transmission(Buffer_t const& buffer)
+	void start_transmission(Buffer_t const& buffer, unsigned length) {
+		start_transmission(buffer.data(), length);
+	}
+
+	void start_transmission(uint8_t const* data, unsigned length)
 	{
-		while(transmission_pending);
-		Interface::send_mode();
-		Interface::uart::write(buffer.data(), buffer.size());
-		transmission_pending = true;
+		if (not queue.push(data, length))
+			++dropped;
+		/* TC is set while idle, so this triggers the interrupt at once */
+		Interface::uart::enableTransmitCompleteInterrupt();
 	}
 
-	void check_transmission_finished(void)
+	/* to be called from the UART's interrupt */
+	void transmit_complete(void)
 	{
-		if (transmission_pending && Interface::uart::isWriteFinished()) {
-			Interface::recv_mode();
-			transmission_pending = false;
+		if (in_flight) {
+			queue.pop();
+			in_flight = false;
 		}
-		//TODO transceiver disable could be done with interrupt
+		if (queue.empty()) {
+			Interface::uart::disableTransmitCompleteInterrupt();
+			if (sending) {
+				Interface::recv_mode();
+				sending = false;
+			}
+			return;
+		}
+		if (not sending) {
+			Interface::send_mode();
+			sending = true;
+		}
+		Interface::uart::writeDirect(queue.front(), queue.front_length()); /* clears TC */
+		in_flight = true;
 	}
 
+	/* frames dropped since start, because the queue was full */
+	uint16_t get_dropped(void) const { return dropped; }
+
 };
 
 
@@ -0,0 +1,132 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_SYNCDIAG_HPP
+#define SUPREME_LIMBCTRL_SYNCDIAG_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace supreme {
+
+/* Timing diagnostics of the spinal cord synchronization.
+
+   Once per frame, the start of the leading board's slot (i.e. its second
+   sync byte) is time stamped with the cycle counter:
+
+     offset : time stamp minus the sync bytes' transmission time, relative
+              to this board's frame start, minus the slot's start in the
+              slot table [100 ns], i.e. the phase error of the frame timer
+              (see clocksync.hpp), within one byte time (see communication.hpp)
+     period : time between the time stamps of consecutive frames, minus
+              the frame time, i.e. the clock error of this board against
+              the leader over one frame, plus jitter [ns]
+     drift  : moving average of the period error (1/16 per frame)
+     jitter : |period error - drift|, counted in a histogram with bins
+              < 125, 250, 500, 1000, 2000, 4000, 8000 ns and above
+
+   Statistics are collected over a window of 256 frames (frame counter
+   wrap), then published as a record of 16 bytes, which is sent one byte
+   per frame in the spinal cord slot (status byte, shared with the fault
+   log and the board health, see faults.hpp, health.hpp), byte i in
+   frames with i = frame % 16 and frame % 32 < 16:
+
+     [0,1] last offset  [100 ns, int16, MSB first]
+     [2,3] min. offset  [100 ns]
+     [4,5] max. offset  [100 ns]
+     [6,7] drift        [ns]
+     [8..15] histogram  [counts, saturated]
+
+   Values are saturated to int16. A board which leads has no measurements,
+   its histogram is empty and min > max. */
+namespace syncdiag {
+
+	constexpr unsigned num_bins     = 8;
+	constexpr unsigned record_bytes = 16;
+	constexpr unsigned drift_shift  = 4;
+	constexpr int32_t  bin0_ns      = 125;
+
+	struct Record {
+		int16_t offset;
+		int16_t min;
+		int16_t max;
+		int16_t drift;
+		std::array<uint8_t, num_bins> histogram;
+	};
+
+	constexpr int16_t saturate(int32_t x) { return (x > 32767) ? 32767 : (x < -32767) ? -32767 : x; }
+
+	constexpr uint8_t bin(int32_t jitter_ns) {
+		uint8_t b = 0;
+		if (jitter_ns < 0) jitter_ns = -jitter_ns;
+		while (b < num_bins - 1 and jitter_ns >= (bin0_ns << b)) ++b;
+		return b;
+	}
+
+	class SyncDiagnostics {
+	public:
+		SyncDiagnostics() : published(), current() { reset(); published = current; }
+
+		/* measurement of the leading board's slot, at most once per frame,
+		   the period error is only valid for consecutive frames */
+		void measure(int32_t offset_100ns, int32_t period_error_ns, bool consecutive) {
+			const int16_t x = saturate(offset_100ns);
+			current.offset = x;
+			if (x < current.min) current.min = x;
+			if (x > current.max) current.max = x;
+
+			if (not consecutive) return;
+			const int16_t e = saturate(period_error_ns);
+			drift_acc += e - (drift_acc >> drift_shift);
+			current.drift = drift_acc >> drift_shift;
+			uint8_t& h = current.histogram[bin(e - current.drift)];
+			if (h < 255) ++h;
+		}
+
+		/* call once per frame, publishes the statistics on frame counter wrap */
+		void next_frame(uint8_t frame) {
+			if (frame != 0) return;
+			published = current;
+			reset();
+		}
+
+		Record const& get_record(void) const { return published; }
+
+		/* byte of the published record for the given frame */
+		uint8_t get_byte(uint8_t frame) const {
+			const uint8_t i = frame % record_bytes;
+			const Record& r = published;
+			switch (i) {
+				case 0: return (uint16_t) r.offset >> 8;
+				case 1: return (uint16_t) r.offset & 0xff;
+				case 2: return (uint16_t) r.min    >> 8;
+				case 3: return (uint16_t) r.min    & 0xff;
+				case 4: return (uint16_t) r.max    >> 8;
+				case 5: return (uint16_t) r.max    & 0xff;
+				case 6: return (uint16_t) r.drift  >> 8;
+				case 7: return (uint16_t) r.drift  & 0xff;
+				default: return r.histogram[i - 8];
+			}
+		}
+
+	private:
+		void reset(void) {
+			current.min = 32767;
+			current.max = -32767;
+			current.histogram.fill(0);
+		}
+
+		Record  published;
+		Record  current;
+		int32_t drift_acc = 0; /* drift << drift_shift */
+	};
+
+} /* namespace syncdiag */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_SYNCDIAG_HPP */
@@ -0,0 +1,235 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_TELEMETRY_HPP
+#define SUPREME_LIMBCTRL_TELEMETRY_HPP
+
+#include <array>
+#include <cstdint>
+#include <src/topology.hpp>
+
+namespace supreme {
+
+/* Compact encoding of the motor data in spinal cord slots.
+
+   Full format, per motor: id, status, num_values words (see Sample).
+   Compact format, per motor: id, status, then either
+     key record   (status bit 7 set): num_values words, as full format
+     delta record : one signed byte per fast value, quantised deltas,
+                    1 word, one of the slow values, alternating per frame
+
+   Motor i of a board sends its key record in every frame with
+   frame % key_interval == i, so a slot holds at most one key record.
+   Deltas are counted in steps of 2^quant_shift of the channel and
+   saturated to +-127 steps. The encoder tracks the value as seen by
+   the decoder, so the error stays within half a step and a saturated
+   delta is caught up within the next frames. So a channel follows at
+   most 127 << quant_shift raw units per frame without lag (see below),
+   faster changes lag behind until caught up or until the next key
+   record. The frame counter of the slot (header byte 'cycles') is used
+   as sequence number, after a lost slot, the motor's data is invalid
+   until its next key record.
+
+   A compact slot is marked by bit 7 in the number of motors. */
+namespace telemetry {
+
+	/* position, current, velocity, supply, temperature, ext. sensor x,y,z,
+	   ext. sensor timestamp (motor's 1kHz tick, when prefetching),
+	   multi-turn position (turns, position), back-EMF, fused velocity,
+	   calibrated position, see the motor's state response 0x80 */
+	constexpr uint8_t num_values = 14;
+	constexpr uint8_t num_slow   = 2;
+	constexpr uint8_t slow[num_slow] = {3, 4}; /* supply, temperature */
+
+	constexpr bool is_slow(uint8_t i) { return i == slow[0] or i == slow[1]; }
+
+	/* resolution of the deltas, log2 of one step, and the largest change
+	   per frame followed without lag, 127 steps */
+	constexpr uint8_t quant_shift[num_values] = { 6   /* position, 10 bit ADC in Q6, 127 counts */
+	                                            , 2   /* current, raw ADC, 508 counts */
+	                                            , 4   /* velocity, 16 * counts/s -> counts/s */
+	                                            , 0, 0 /* slow */
+	                                            , 2, 2, 2 /* ext. sensor, raw, 508 */
+	                                            , 0   /* ext. sensor timestamp, ticks, frames up to 127ms */
+	                                            , 0   /* turns, changing by 1 at most */
+	                                            , 6   /* multi-turn position, as position */
+	                                            , 2   /* back-EMF, raw ADC, 508 counts */
+	                                            , 4   /* fused velocity, as velocity */
+	                                            , 5   /* calibrated position, user units, 4064 */ };
+
+	constexpr uint8_t key_interval = 8; /* frames */
+	constexpr uint8_t key_flag     = 0x80; /* in status byte */
+	constexpr uint8_t compact_flag = 0x80; /* in number of motors */
+
+	/* record sizes, incl. id and status */
+	constexpr unsigned full_record  = 2 + 2 * num_values;
+	constexpr unsigned delta_record = 2 + (num_values - num_slow) + 2;
+
+	/* header: 2 sync, id, length, 7 status bytes, number of motors,
+	   trailer: 4 bytes slot table, checksum */
+	constexpr unsigned header_bytes  = 12;
+	constexpr unsigned trailer_bytes = 5;
+
+	static_assert(topology::max_motors_per_board <= key_interval, "Too many motors for key interval.");
+	static_assert(topology::slot_bytes(1) == header_bytes + full_record + trailer_bytes, "Slot format mismatch.");
+
+	typedef std::array<uint16_t, num_values> Sample;
+
+	constexpr bool is_key(uint8_t frame, uint8_t motor_idx) { return frame % key_interval == motor_idx; }
+
+	/* max. length of a compact slot */
+	constexpr unsigned compact_slot_bytes(uint8_t num_motors) {
+		return header_bytes + trailer_bytes
+		     + ((num_motors > 0) ? (num_motors - 1) * delta_record + full_record : 0);
+	}
+
+	/* length of a compact slot in the given frame */
+	constexpr unsigned compact_slot_bytes(uint8_t num_motors, uint8_t frame) {
+		return header_bytes + trailer_bytes + num_motors * delta_record
+		     + ((frame % key_interval < num_motors) ? full_record - delta_record : 0);
+	}
+
+	inline int8_t saturate(int d) { return (d > 127) ? 127 : (d < -127) ? -127 : d; }
+
+	/* delta from r to s in steps of the channel, rounded */
+	inline int8_t quantise(uint8_t i, uint16_t s, uint16_t r) {
+		const int d = (int16_t) (s - r);
+		return saturate((d + ((1 << quant_shift[i]) >> 1)) >> quant_shift[i]);
+	}
+
+	inline uint16_t dequantise(uint8_t i, int8_t d) { return (uint16_t) (d * (1 << quant_shift[i])); }
+
+	/* Encodes the motor records of one board. Sink must provide
+	   add_byte() and add_word(), e.g. the spinal cord's sendbuffer. */
+	template <uint8_t MaxMotors>
+	class Encoder {
+		std::array<Sample, MaxMotors> recon; /* values as seen by decoder */
+
+	public:
+		Encoder() : recon() {}
+
+		template <typename Sink>
+		void encode(Sink& out, uint8_t frame, uint8_t idx, uint8_t id, uint8_t status, Sample const& s)
+		{
+			Sample& r = recon[idx];
+			const bool key = is_key(frame, idx);
+
+			out.add_byte(id);
+			out.add_byte((status & ~key_flag) | (key ? key_flag : 0));
+
+			if (key) {
+				for (uint8_t i = 0; i < num_values; ++i)
+					out.add_word(s[i]);
+				r = s;
+				return;
+			}
+
+			for (uint8_t i = 0; i < num_values; ++i) {
+				if (is_slow(i)) continue;
+				const int8_t d = quantise(i, s[i], r[i]);
+				out.add_byte((uint8_t) d);
+				r[i] += dequantise(i, d);
+			}
+			const uint8_t k = slow[frame % num_slow];
+			out.add_word(s[k]);
+			r[k] = s[k];
+		}
+	};
+
+	/* Decodes the motor records of all boards. */
+	template <uint8_t MaxBoards, uint8_t MaxMotors>
+	class Decoder {
+		std::array<std::array<Sample, MaxMotors>, MaxBoards> recon;
+		std::array<uint8_t, MaxBoards> last_frame;
+		std::array<uint8_t, MaxBoards> valid; /* bit mask of motors */
+
+	public:
+		Decoder() : recon(), last_frame(), valid() {}
+
+		/* call once per compact slot, before decoding its records */
+		void begin(uint8_t board, uint8_t frame) {
+			if (frame != (uint8_t) (last_frame[board] + 1))
+				valid[board] = 0; /* slot lost, wait for key records */
+			last_frame[board] = frame;
+		}
+
+		/* decodes one record starting at data (after id and status),
+		   returns false if the motor has no valid data (yet) */
+		bool decode(uint8_t board, uint8_t frame, uint8_t idx, bool key, uint8_t const* data, Sample& out) {
+			Sample& r = recon[board][idx];
+			if (key) {
+				for (uint8_t i = 0; i < num_values; ++i)
+					r[i] = data[2*i] << 8 | data[2*i+1];
+				valid[board] |= 1 << idx;
+			} else {
+				uint8_t p = 0;
+				for (uint8_t i = 0; i < num_values; ++i) {
+					if (is_slow(i)) continue;
+					r[i] += dequantise(i, (int8_t) data[p++]);
+				}
+				r[slow[frame % num_slow]] = data[p] << 8 | data[p+1];
+			}
+			out = r;
+			return valid[board] & (1 << idx);
+		}
+	};
+
+	/* Expands a compact slot to the full format, returns the length of
+	   the expanded slot (incl. checksum) or 0 if the slot is malformed.
+	   Motors without valid data are reported not connected (status 0). */
+	template <typename Decoder_t, typename Buffer_t>
+	unsigned expand(Decoder_t& decoder, Buffer_t const& in, unsigned length, Buffer_t& out)
+	{
+		if (length < header_bytes + trailer_bytes or length > in.size()) return 0;
+
+		const uint8_t board = in[2];
+		const uint8_t frame = in[9];
+		const uint8_t num_motors = in[header_bytes-1] & ~compact_flag;
+		if (board >= topology::max_boards or num_motors > topology::max_motors_per_board) return 0;
+		if (header_bytes + num_motors * full_record + trailer_bytes > out.size()) return 0;
+
+		decoder.begin(board, frame);
+
+		for (unsigned i = 0; i < header_bytes - 1; ++i)
+			out[i] = in[i];
+		out[header_bytes-1] = num_motors;
+
+		unsigned pin = header_bytes, pout = header_bytes;
+		const unsigned end = length - trailer_bytes;
+		for (uint8_t m = 0; m < num_motors; ++m) {
+			if (pin + 2 > end) return 0;
+			const bool key = in[pin+1] & key_flag;
+			if (pin + (key ? full_record : delta_record) > end) return 0;
+
+			Sample s;
+			const bool ok = decoder.decode(board, frame, m, key, &in[pin+2], s);
+			out[pout++] = in[pin];
+			out[pout++] = ok ? (in[pin+1] & ~key_flag) : 0;
+			for (uint8_t i = 0; i < num_values; ++i) {
+				out[pout++] = s[i] >> 8;
+				out[pout++] = s[i] & 0xff;
+			}
+			pin += key ? full_record : delta_record;
+		}
+		if (pin != end) return 0;
+
+		for (unsigned i = 0; i < trailer_bytes - 1; ++i) /* slot table */
+			out[pout++] = in[pin++];
+
+		out[3] = pout + 1; /* new length */
+		uint8_t sum = 0;
+		for (unsigned i = 0; i < pout; ++i)
+			sum += out[i];
+		out[pout++] = ~sum + 1; /* two's complement checksum */
+		return pout;
+	}
+
+} /* namespace telemetry */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_TELEMETRY_HPP */
@@ -0,0 +1,111 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_TOPOLOGY_HPP
+#define SUPREME_LIMBCTRL_TOPOLOGY_HPP
+
+#include <cstdint>
+
+namespace supreme {
+
+/* Robot topology: maps each board (spinal cord id) to the ids of the
+   sensorimotors on its motor cord. Motor ids double as index into the
+   voltages of the transparent data, hence all motor ids must be unique
+   and less than the number of voltages.
+
+   The table is selected at compile time (see main.cpp), which determines
+   the size of the spinal cord slots and transparent frames. The table of
+   the board's config (see config.hpp) replaces it at runtime, as long as
+   it fits into these sizes. */
+namespace topology {
+
+	constexpr uint8_t max_boards           = 8; /* spinal cord ids 0..7 */
+	constexpr uint8_t max_motors_per_board = 4;
+	constexpr uint8_t max_voltages         = 32;
+
+	struct BoardEntry {
+		uint8_t num_motors;
+		uint8_t motor_ids[max_motors_per_board];
+	};
+
+	struct Table {
+		uint8_t    num_boards;
+		uint8_t    num_voltages; /* motor ids are 0..num_voltages-1 */
+		BoardEntry boards[max_boards];
+	};
+
+	/* slot size: 2 sync, board id, length, 7 status bytes, number of motors,
+	   30 bytes per motor (id, status, 14 words, see telemetry.hpp), 4 bytes
+	   slot table (see slottable.hpp), checksum */
+	constexpr unsigned slot_bytes(uint8_t num_motors) { return 12 + 30u * num_motors + 4 + 1; }
+
+	/* transparent frame: 2 sync, id, 2 bytes per voltage, checksum */
+	constexpr unsigned transparent_bytes(uint8_t num_voltages) { return 3 + 2u * num_voltages + 1; }
+
+	constexpr uint8_t max_motors(Table const& t) {
+		uint8_t n = 0;
+		for (uint8_t b = 0; b < t.num_boards and b < max_boards; ++b)
+			if (t.boards[b].num_motors > n) n = t.boards[b].num_motors;
+		return n;
+	}
+
+	/* max. slot size of a table, rounded up to multiples of 8 */
+	constexpr unsigned slot_size(Table const& t) { return (slot_bytes(max_motors(t)) + 7) / 8 * 8; }
+
+	constexpr bool is_valid(Table const& t, unsigned slot_capacity, unsigned voltage_capacity) {
+		if (t.num_boards == 0 or t.num_boards > max_boards) return false;
+		if (t.num_voltages > voltage_capacity or t.num_voltages > max_voltages) return false;
+
+		uint32_t used = 0; /* bit mask of motor ids */
+		for (uint8_t b = 0; b < t.num_boards; ++b) {
+			BoardEntry const& e = t.boards[b];
+			if (e.num_motors > max_motors_per_board) return false;
+			if (slot_bytes(e.num_motors) > slot_capacity) return false;
+			for (uint8_t i = 0; i < e.num_motors; ++i) {
+				const uint8_t id = e.motor_ids[i];
+				if (id >= t.num_voltages) return false;
+				if (used & (1ul << id)) return false; /* not unique */
+				used |= 1ul << id;
+			}
+		}
+		return true;
+	}
+
+	constexpr bool is_valid(Table const& t) { return is_valid(t, slot_size(t), t.num_voltages); }
+
+	/* empty entry for boards without motors, e.g. trunk controller */
+	constexpr BoardEntry none = { 0, {0, 0, 0, 0} };
+
+	/* 4 limbs with 3 motors each, board 4 is the trunk controller,
+	   motor ids follow the former formula: board_id/2*6 + board_id%2 + 2*j */
+	constexpr Table quadruped = { 8, 12, { { 3, { 0, 2,  4} }
+	                                     , { 3, { 1, 3,  5} }
+	                                     , { 3, { 6, 8, 10} }
+	                                     , { 3, { 7, 9, 11} }
+	                                     , none, none, none, none } };
+
+	/* 6 legs, front and rear legs with 4 joints, middle legs with 3,
+	   board 4 is the trunk controller */
+	constexpr Table hexapod = { 8, 22, { { 4, {  0,  1,  2,  3} }
+	                                   , { 4, {  4,  5,  6,  7} }
+	                                   , { 3, {  8,  9, 10} }
+	                                   , { 3, { 11, 12, 13} }
+	                                   , none
+	                                   , { 4, { 14, 15, 16, 17} }
+	                                   , { 4, { 18, 19, 20, 21} }
+	                                   , none } };
+
+	static_assert(is_valid(quadruped), "Invalid topology.");
+	static_assert(is_valid(hexapod), "Invalid topology.");
+	static_assert(slot_size(quadruped) == 112, "Slot size changed.");
+	static_assert(transparent_bytes(quadruped.num_voltages) == 28, "Frame size changed.");
+
+} /* namespace topology */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_TOPOLOGY_HPP */
@@ -0,0 +1,181 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_LIMBCTRL_TRACE_HPP
+#define SUPREME_LIMBCTRL_TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace supreme {
+
+/* Trace of the frame cycle: time stamped state transitions, slot
+   receptions, timer events and timeouts, kept in a ring in RAM, the
+   oldest entries are overwritten. Entries are added from the main loop
+   and from interrupts, each writer claims its entry by an atomic
+   increment. While the trace is dumped, it is frozen, i.e. new entries
+   are dropped.
+
+   Entry (8 bytes, MSB first):
+     [0..3] time [cycle counter]
+     [4]    kind, see below
+     [5]    frame counter
+     [6]    arg, e.g. the new state or a board id
+     [7]    data, e.g. a slot's length
+
+   The trace is dumped on request via the external port, the request is
+   2 sync, id 0xFC, checksum. It is answered with one chunk per frame:
+     [0,1] sync bytes
+     [2]   id 0xFC
+     [3]   board id
+     [4]   chunk index
+     [5]   number of chunks
+     [6]   number of entries in this chunk
+     [7..] entries, oldest first
+     [n-1] checksum
+   See tools/trace_dump.py for a decoder. */
+namespace trace {
+
+	constexpr uint8_t  dump_id           = 0xFC;
+	constexpr unsigned request_bytes     = 4;
+	constexpr unsigned entry_bytes       = 8;
+	constexpr unsigned entries_per_chunk = 32;
+	constexpr unsigned header_bytes      = 7;
+	constexpr unsigned chunk_bytes       = header_bytes + entries_per_chunk * entry_bytes + 1;
+
+	enum Kind : uint8_t {
+		none        = 0,
+		state       = 1, /* arg: new state of the main loop */
+		frame_start = 2, /* frame timer */
+		slot        = 3, /* arg: board id, data: length, time: sync bytes */
+		rx_timeout  = 4, /* slot incomplete */
+		send_slot   = 5, /* local delay is over */
+		comm_end    = 6, /* all slots are over */
+		motor_phase = 7, /* or motor response timeout */
+		failover    = 8, /* arg: new leading board */
+		holdover    = 9, /* arg: missed frames */
+	};
+
+	struct Entry {
+		uint32_t time;
+		uint8_t  kind;
+		uint8_t  frame;
+		uint8_t  arg;
+		uint8_t  data;
+	};
+
+	template <unsigned N>
+	class Ring {
+		static_assert((N & (N - 1)) == 0, "Number of entries must be a power of 2.");
+
+	public:
+		static constexpr unsigned num_chunks = (N + entries_per_chunk - 1) / entries_per_chunk;
+
+		Ring() : entries(), count(0) {}
+
+		void add(Kind kind, uint32_t time, uint8_t arg = 0, uint8_t data = 0) {
+			if (frozen) return;
+			const uint32_t i = count.fetch_add(1, std::memory_order_relaxed);
+			entries[i & (N - 1)] = { time, kind, frame, arg, data };
+		}
+
+		/* frame counter of following entries */
+		void set_frame(uint8_t f) { frame = f; }
+
+		void freeze  (void) { frozen = true;  }
+		void unfreeze(void) { frozen = false; }
+		bool is_frozen(void) const { return frozen; }
+
+		/* number of valid entries, oldest first */
+		unsigned size(void) const {
+			const uint32_t n = count.load(std::memory_order_relaxed);
+			return (n < N) ? n : N;
+		}
+
+		Entry const& get(unsigned i) const {
+			const uint32_t first = count.load(std::memory_order_relaxed) - size();
+			return entries[(first + i) & (N - 1)];
+		}
+
+		/* writes chunk <c> of the frozen trace into <buffer>, returns its length */
+		template <uint8_t SyncByte>
+		unsigned get_chunk(uint8_t c, uint8_t board_id, std::array<uint8_t, chunk_bytes>& buffer) const {
+			const unsigned first = c * entries_per_chunk;
+			const unsigned n = (first >= size()) ? 0
+			                 : (size() - first < entries_per_chunk) ? size() - first : entries_per_chunk;
+			buffer[0] = SyncByte;
+			buffer[1] = SyncByte;
+			buffer[2] = dump_id;
+			buffer[3] = board_id;
+			buffer[4] = c;
+			buffer[5] = num_chunks;
+			buffer[6] = n;
+			unsigned length = header_bytes;
+			for (unsigned i = 0; i < n; ++i) {
+				Entry const& e = get(first + i);
+				buffer[length++] = e.time >> 24;
+				buffer[length++] = e.time >> 16;
+				buffer[length++] = e.time >>  8;
+				buffer[length++] = e.time;
+				buffer[length++] = e.kind;
+				buffer[length++] = e.frame;
+				buffer[length++] = e.arg;
+				buffer[length++] = e.data;
+			}
+			uint8_t sum = 0;
+			for (unsigned i = 0; i < length; ++i)
+				sum += buffer[i];
+			buffer[length++] = ~sum + 1; /* two's complement checksum */
+			return length;
+		}
+
+	private:
+		std::array<Entry, N>  entries;
+		std::atomic<uint32_t> count; /* entries written since start */
+		volatile uint8_t      frame  = 0;
+		volatile bool         frozen = false;
+	};
+
+	/* sends the frozen trace, one chunk per call */
+	template <typename Ring_t>
+	class Dump {
+	public:
+		Dump(Ring_t& ring) : ring(ring) {}
+
+		void start(void) {
+			if (active) return;
+			ring.freeze();
+			chunk  = 0;
+			active = true;
+		}
+
+		bool is_active(void) const { return active; }
+
+		/* next chunk into <buffer>, returns its length, 0 if done */
+		template <uint8_t SyncByte>
+		unsigned next(uint8_t board_id, std::array<uint8_t, chunk_bytes>& buffer) {
+			if (not active) return 0;
+			const unsigned length = ring.template get_chunk<SyncByte>(chunk, board_id, buffer);
+			if (++chunk >= Ring_t::num_chunks) {
+				active = false;
+				ring.unfreeze();
+			}
+			return length;
+		}
+
+	private:
+		Ring_t& ring;
+		uint8_t chunk  = 0;
+		bool    active = false;
+	};
+
+} /* namespace trace */
+
+} /* namespace supreme */
+
+#endif /* SUPREME_LIMBCTRL_TRACE_HPP */
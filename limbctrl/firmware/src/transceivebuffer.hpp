@@ -25,12 +25,14 @@ class sendbuffer {
 	uint16_t ptr = NumSyncBytes;
 	Buffer_t buffer;
 	uint8_t  checksum = chk_init;
+	bool     pending  = false;
 
 public:
 	sendbuffer()
 	: buffer()
 	{
 		static_assert(N > NumSyncBytes, "Invalid buffer size.");
+		static_assert(N <= Interface::uart::tx_size, "Buffer exceeds the uart's transmit buffer.");
 		for (uint8_t i = 0; i < NumSyncBytes; ++i)
 			buffer[i] = SyncByte; // init sync bytes once
 	}
@@ -59,6 +61,25 @@ public:
 		ptr = NumSyncBytes;
 	}
 
+	/* non-blocking transmit, the uart takes a copy of the buffer,
+	   the bus is released in check_transmission_finished() */
+	void start_transmission() {
+		if (ptr == NumSyncBytes) return;
+		add_checksum();
+		Interface::send_mode();
+		Interface::uart::write(buffer.data(), ptr);
+		pending = true;
+		/* prepare next */
+		ptr = NumSyncBytes;
+	}
+
+	void check_transmission_finished() {
+		if (pending and Interface::uart::isWriteFinished()) {
+			Interface::recv_mode();
+			pending = false;
+		}
+	}
+
 	uint16_t size(void) const { return ptr; }
 	Buffer_t const& get(void) const { return buffer; }
 
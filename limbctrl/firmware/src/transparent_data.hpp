@@ -9,6 +9,7 @@
 #define SUPREME_LIMBCTRL_TRANSPARENT_DATA_HPP
 
 #include <src/transceivebuffer.hpp>
+#include <src/trace.hpp>
 
 namespace supreme {
 
@@ -16,6 +17,7 @@ template <typename RXInterface, typename TXInterface, unsigned NumTransparentByt
 class TransparentData
 {
 	bool sync_state = false;
+	uint8_t id = 0;
 
 	recvbuffer<RXInterface, NumTransparentBytes> recv;
 	sendbuffer<TXInterface, NumTransparentBytes, SyncByte>        send;
@@ -39,6 +41,12 @@ public:
 
 	void clear(void) { recv.reset(); }
 
+	/* waiting for the next byte, i.e. read() has nothing to do without new data */
+	bool is_waiting(void) const { return state >= synchronizing and state <= reading_data; }
+
+	/* the last frame read was a request to dump the trace, not transparent data */
+	bool is_dump_request(void) const { return id == trace::dump_id; }
+
 	bool read(void)
 	{
 		bool result = false;
@@ -103,10 +111,14 @@ private:
 		return recv_state_t::synchronizing;
 	}
 
-	recv_state_t get_id() { return (recv.get_data() == 0xff) ? reading_data : error; }
+	recv_state_t get_id() {
+		id = recv.get_data();
+		return (id == 0xff or id == trace::dump_id) ? reading_data : error;
+	}
 
 	recv_state_t get_data() {
-		return (recv.bytes_received() < NumTransparentBytes) ? reading_data : validating;
+		const unsigned expected = (id == trace::dump_id) ? trace::request_bytes : NumTransparentBytes;
+		return (recv.bytes_received() < expected) ? reading_data : validating;
 	}
 
 };
@@ -15,6 +15,8 @@
 #include <src/timer.hpp>
 #include <src/math.hpp>
 #include <src/transceivebuffer.hpp>
+#include <src/cyclecounter.hpp>
+#include <src/polling.hpp>
 
 using namespace Board;
 
@@ -32,8 +34,9 @@ template <typename Interface_t, typename Timer_t>
 class ux_communication_ctrl {
 public:
 
-	static const unsigned motor_timeout_us = 500;
-	static const unsigned wait_before_next_us = 100;
+	static const unsigned motor_timeout_us = 500; /* default and upper limit */
+	static const unsigned timeout_margin_us = 50; /* min., see polling.hpp */
+	static const unsigned turnaround_guard_us = 5; /* bus released by motor */
 
 	enum request_id_t {
 		ping,
@@ -41,6 +44,7 @@ public:
 		set_voltage,
 		set_pwm_limit, /* no response */
 		ext_sensor_request,
+		set_voltage_ext_sensor,
 	};
 
 	enum response_id_t {
@@ -48,6 +52,7 @@ public:
 		data_requested_response,
 		ping_response,
 		ext_sensor_request_resp,
+		data_ext_sensor_response,
 	};
 
 	enum recv_state_t {
@@ -81,14 +86,18 @@ public:
 		uint16_t voltage_supply = 0;
 		uint16_t temperature    = 0;
 		uint16_t ext_sensor[3]  = {0,0,0};
-		//uint16_t voltage_back_emf; <-- currently not in use
+		uint16_t ext_sensor_timestamp = 0; /* tick of the motor, when prefetching */
+		uint32_t position_multiturn = 0;
+		uint16_t voltage_back_emf = 0;
+		uint16_t velocity_fused = 0;
+		 int16_t position_calibrated = 0;
 	};
 
 private:
 
 	static const uint8_t syncbyte = 0xff;
 
-	typedef recvbuffer<Interface_t, 32          > RecvBuffer_t;
+	typedef recvbuffer<Interface_t, 40          > RecvBuffer_t;
 	typedef sendbuffer<Interface_t, 16, syncbyte> SendBuffer_t;
 
 	RecvBuffer_t                 recv_msg;
@@ -98,7 +107,7 @@ private:
 
 	/* motor related */
 	pwm_t                        target_pwm = {0, false};
-	const uint8_t                limit_pwm = 128; //TODO include in transparent data?
+	bool                         setup_pending = true;
 
 	response_id_t                cmd_id    = unrecognized_command;
 	recv_state_t                 cmd_state = syncing;
@@ -110,48 +119,71 @@ private:
 	uint16_t                     errors = 0;
 	connection_status_t          connection_status = connection_status_t::not_connected;
 
+	/* response timing */
+	uint32_t                     request_sent = 0;
+	LatencyStats                 latency;
+	Backoff<>                    backoff;
+
 public:
 
-	ux_communication_ctrl(uint8_t motor_id) : send_msg(), motor_id(motor_id), status_data() {
+	ux_communication_ctrl(uint8_t motor_id = 0) : send_msg(), motor_id(motor_id), status_data() {
 		assert(motor_id < 127, 6);
 	}
 
 	void enable_ext_sensor_reading(bool enable = true) { readout_ext_sensor = enable; }
-
-	bool read_ext_sensor(volatile bool* is_timed_out) {
-		if (not readout_ext_sensor) return true; // done
-		return step(is_timed_out, ext_sensor_request);
+	bool reads_ext_sensor(void) const { return readout_ext_sensor; }
+
+	/* set voltage and read state, merged with the
+	   ext. sensor's readout (if enabled) into one transaction */
+	bool update(volatile bool* is_timed_out) {
+		/* unresponsive motors are polled with exponential backoff */
+		if (connection_status == not_connected and not backoff.poll_now())
+			return true; // skip this cycle
+		return step(is_timed_out, readout_ext_sensor ? set_voltage_ext_sensor : set_voltage);
 	}
 
-	bool ping_and_setup(volatile bool* is_timed_out) {
-		*is_timed_out = false;
-		assert(*is_timed_out == false, 0xAA);
-		assert(connection_status == not_connected, 0xAB);
-		while(!step(is_timed_out, ping));
-		if (connection_status != is_connected)
-			return false; // abort further setup
-
-		send_voltage_limit();
-		*is_timed_out = false;
-		start_timer(wait_before_next_us);
-		while(not *is_timed_out);
-		return true;
+	/* motor responded to the discovery broadcast */
+	void set_discovered(void) {
+		connection_status = is_connected;
+		backoff.succeeded();
 	}
 
+	/* motor is connected, but was not set up since it (re-)connected */
+	bool needs_setup(void) const { return setup_pending and connection_status == is_connected; }
+	void setup_done(void) { setup_pending = false; }
+
 	void set_target_voltage(scdata_t target_voltage) {
 		target_pwm = sc_to_pwm(target_voltage);
 	}
 
 	bool step(volatile bool* is_timed_out, request_id_t req_id = request_id_t::set_voltage)
 	{
+		/* a complete response is accepted, even if the timer expired
+		   after its last byte, but before the timer was paused */
+		if (connection_status == responded)
+		{
+			/* pipelined: the next request may be sent right away,
+			   only wait for the motor to release the bus */
+			Timer_t::pause();
+			latency.add(cyclecounter::to_us(cyclecounter::elapsed(request_sent)));
+			backoff.succeeded();
+			xpcc::delayMicroseconds(turnaround_guard_us);
+			connection_status = is_connected;
+			return true;
+		}
+
 		if (*is_timed_out)
 		{
 			switch(connection_status)
 			{
-			case request_pending: connection_status = not_connected; break;
-			case waiting:         connection_status =  is_connected; break;
-			default:
-				assert(false, 78);
+			case request_pending:
+				connection_status = not_connected;
+				setup_pending = true; /* might be rebooting */
+				backoff.failed();
+				latency.timed_out(); /* next request with default timeout */
+				break;
+			default: /* timed out without request */
+				if (fault(78) == faults::reset) reset_transaction();
 				break;
 			}
 			return true;
@@ -160,13 +192,6 @@ public:
 		// otherwise...timer still active
 		switch(connection_status)
 		{
-		case waiting: /* waiting */ return false;
-
-		case responded:
-			start_timer(wait_before_next_us);
-			connection_status = waiting;
-			return false;
-
 		case request_pending:
 			while(receive_response());
 			break;
@@ -178,7 +203,7 @@ public:
 			break;
 
 		default: /* unknown state */
-			assert(false, 79);
+			if (fault(79) == faults::reset) reset_transaction();
 			break;
 		}
 		return false;
@@ -186,6 +211,7 @@ public:
 
 	connection_status_t get_connection_status(void) const { return connection_status; }
 	StatusData_t const& get_status_data(void) const { return status_data; }
+	LatencyStats const& get_latency(void) const { return latency; }
 
 	uint8_t get_id(void) const { return motor_id; }
 
@@ -204,21 +230,14 @@ private:
 		send_msg.transmit();
 	}
 
-	void send_motor_request(void) {
-		const uint8_t cmd = target_pwm.dir ? 0xB1 : 0xB0;
+	void send_motor_request(bool with_ext_sensor = false) {
+		const uint8_t cmd = (with_ext_sensor ? 0xB2 : 0xB0) | (target_pwm.dir ? 0x1 : 0x0);
 		send_msg.add_byte(cmd);
 		send_msg.add_byte(motor_id);
 		send_msg.add_byte(target_pwm.dc);
 		send_msg.transmit();
 	}
 
-	void send_voltage_limit(void) {
-		send_msg.add_byte(0xA0);
-		send_msg.add_byte(motor_id);
-		send_msg.add_byte(limit_pwm);
-		send_msg.transmit();
-	}
-
 	void send_ext_sensor_req(uint8_t sensor_id = 1) {
 		send_msg.add_byte(0x40);
 		send_msg.add_byte(motor_id);
@@ -232,11 +251,16 @@ private:
 		case data_requested     : send_state_request();  break;
 		case set_voltage        : send_motor_request();  break;
 		case ext_sensor_request : send_ext_sensor_req(); break;
+		case set_voltage_ext_sensor: send_motor_request(true); break;
 		case set_pwm_limit      : /* not allowed to call this way */
-		default                 : assert(false, 76);     break;
+		default:
+			if (fault(76) == faults::reset) reset_transaction();
+			break; /* nothing sent, times out */
 		}
 
-		start_timer(motor_timeout_us);
+		/* timeout adapted to the motor's measured response latency */
+		request_sent = cyclecounter::now();
+		start_timer(latency.get_timeout(timeout_margin_us, motor_timeout_us));
 	}
 
 	void start_timer(unsigned time_us) {
@@ -244,6 +268,17 @@ private:
 		reset_and_start_timer<Timer_t>();
 	}
 
+	/* recovers from an unexpected state, the motor is treated as lost
+	   until it responds again and is set up anew */
+	void reset_transaction(void) {
+		cmd_id = unrecognized_command;
+		cmd_state = syncing;
+		sync_state = false;
+		recv_msg.reset();
+		connection_status = not_connected;
+		setup_pending = true;
+	}
+
 	recv_state_t waiting_for_id()
 	{
 		if (recv_msg.get_data() > 127) return error;
@@ -253,6 +288,7 @@ private:
 			case ping_response:           return verifying;
 			case data_requested_response: return reading;
 			case ext_sensor_request_resp: return reading;
+			case data_ext_sensor_response: return reading;
 			default: /* unknown command */ break;
 		}
 		assert(false, 3);
@@ -264,9 +300,11 @@ private:
 		switch(cmd_id)
 		{
 			case data_requested_response:
-				return (recv_msg.bytes_received() < 14 /*excl. checksum*/) ? reading : verifying;
+				return (recv_msg.bytes_received() < 24 /*excl. checksum*/) ? reading : verifying;
 			case ext_sensor_request_resp:
 				return (recv_msg.bytes_received() < 10 /*excl. checksum*/) ? reading : verifying;
+			case data_ext_sensor_response:
+				return (recv_msg.bytes_received() < 32 /*excl. checksum*/) ? reading : verifying;
 			default: /* unrecognized command */
 				break;
 		}
@@ -283,6 +321,7 @@ private:
 			case 0xE1: /* 1110.0001 */ cmd_id = ping_response;           break;
 			case 0x80: /* 1000.0000 */ cmd_id = data_requested_response; break;
 			case 0x41: /* 0100.0001 */ cmd_id = ext_sensor_request_resp; break;
+			case 0x81: /* 1000.0001 */ cmd_id = data_ext_sensor_response; break;
 			default: /* unrecognized command */
 				return error;
 		} /* switch recv.data */
@@ -314,19 +353,20 @@ private:
 				break;
 
 			case data_requested_response:
-				status_data.position         = recv_msg.get_word( 4);
-				status_data.current          = recv_msg.get_word( 6);
-				status_data.velocity         = recv_msg.get_word( 8);
-				status_data.voltage_supply   = recv_msg.get_word(10);
-				status_data.temperature      = recv_msg.get_word(12);
-				//TODO add voltage_backemf and target voltage readback
+				read_status_data();
+				//TODO add target voltage readback
 				connection_status = connection_status_t::responded;
 				break;
 
 			case ext_sensor_request_resp:
-				status_data.ext_sensor[0] = recv_msg.get_word(4);
-				status_data.ext_sensor[1] = recv_msg.get_word(6);
-				status_data.ext_sensor[2] = recv_msg.get_word(8);
+				read_ext_sensor_data(4);
+				connection_status = connection_status_t::responded;
+				break;
+
+			case data_ext_sensor_response:
+				read_status_data();
+				read_ext_sensor_data(24);
+				status_data.ext_sensor_timestamp = recv_msg.get_word(30);
 				connection_status = connection_status_t::responded;
 				break;
 
@@ -338,6 +378,27 @@ private:
 		return finished;
 	}
 
+	void read_status_data(void)
+	{
+		status_data.position         = recv_msg.get_word( 4);
+		status_data.current          = recv_msg.get_word( 6);
+		status_data.velocity         = recv_msg.get_word( 8);
+		status_data.voltage_supply   = recv_msg.get_word(10);
+		status_data.temperature      = recv_msg.get_word(12);
+		status_data.position_multiturn = (uint32_t) recv_msg.get_word(14) << 16
+		                               | recv_msg.get_word(16);
+		status_data.voltage_back_emf = recv_msg.get_word(18);
+		status_data.velocity_fused   = recv_msg.get_word(20);
+		status_data.position_calibrated = recv_msg.get_word(22);
+	}
+
+	void read_ext_sensor_data(unsigned offset)
+	{
+		status_data.ext_sensor[0] = recv_msg.get_word(offset    );
+		status_data.ext_sensor[1] = recv_msg.get_word(offset + 2);
+		status_data.ext_sensor[2] = recv_msg.get_word(offset + 4);
+	}
+
 	/* return code true: continue processing,
 	              false: wait for next byte */
 	bool receive_response()
@@ -387,7 +448,7 @@ private:
 				break;
 
 			default: /* unknown command state */
-				assert(false, 17);
+				if (fault(17) == faults::reset) reset_transaction();
 				break;
 
 		} /* switch cmd_state */
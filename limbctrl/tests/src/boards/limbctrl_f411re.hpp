@@ -0,0 +1,68 @@
+#ifndef TEST_BOARDS_LIMBCTRL_F411RE_HPP
+#define TEST_BOARDS_LIMBCTRL_F411RE_HPP
+
+/* Host stand-in for the board support, the rs485 uarts are queues
+   filled and inspected by the tests, the DWT cycle counter is a
+   variable advanced by the tests. */
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+struct DWT_Type       { uint32_t CTRL = 0; uint32_t CYCCNT = 0; };
+struct CoreDebug_Type { uint32_t DEMCR = 0; };
+
+inline DWT_Type       dwt_stub;
+inline CoreDebug_Type core_debug_stub;
+
+#define DWT                        (&dwt_stub)
+#define CoreDebug                  (&core_debug_stub)
+#define DWT_CTRL_CYCCNTENA_Msk     (1u << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk (1u << 24)
+
+namespace Board {
+
+struct systemClock {
+	static constexpr uint32_t Frequency = 96000000;
+};
+
+struct led_red { static void set(void) {} static void reset(void) {} };
+struct led_ylw { static void set(void) {} static void reset(void) {} };
+
+template <unsigned Id>
+struct uart_stub {
+	static constexpr unsigned tx_size = 160;
+
+	static inline std::deque<uint8_t>  rx; /* to be received */
+	static inline std::vector<uint8_t> tx; /* sent so far */
+
+	static bool read(uint8_t& data) {
+		if (rx.empty()) return false;
+		data = rx.front();
+		rx.pop_front();
+		return true;
+	}
+	static unsigned available(void) { return rx.size(); }
+	static void discardReceiveBuffer(void) { rx.clear(); }
+
+	static void write(uint8_t const* data, unsigned length) { tx.insert(tx.end(), data, data + length); }
+	static void flushWriteBuffer(void) {}
+	static bool isWriteFinished(void) { return true; }
+
+	static void clear(void) { rx.clear(); tx.clear(); }
+};
+
+template <unsigned Id, unsigned baudrate>
+struct rs485_interface {
+	using uart = uart_stub<Id>;
+	static constexpr unsigned baud = baudrate;
+	static void send_mode(void) {}
+	static void recv_mode(void) {}
+};
+
+using rs485_spinalcord = rs485_interface<0, 3000000>;
+using rs485_motorcord  = rs485_interface<1, 1000000>;
+
+} /* namespace Board */
+
+#endif /* TEST_BOARDS_LIMBCTRL_F411RE_HPP */
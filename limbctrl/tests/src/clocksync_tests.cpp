@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "./catch_1.10.0.hpp"
+#include <src/clocksync.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+using namespace clocksync;
+
+/* leader and follower frame timers, in the follower's clock */
+struct Simulation {
+	const uint32_t nominal;
+	const int32_t  drift;  /* leader's frame time - nominal */
+	const int32_t  noise;  /* max. time stamp noise */
+	const int32_t  late;   /* max. time stamp delay, e.g. byte time and interrupts */
+	const uint32_t slot_start = 20000;
+
+	Pll pll;
+	uint32_t leader   = 0; /* start of the leader's frame */
+	uint32_t follower = 0; /* start of the follower's frame */
+	uint8_t  frame    = 0;
+
+	Simulation(uint32_t nominal, int32_t drift, int32_t noise, int32_t initial_phase, int32_t late = 0)
+	: nominal(nominal), drift(drift), noise(noise), late(late), pll(nominal)
+	{
+		leader = 1000000;
+		follower = leader - initial_phase;
+		pll.lock(leader + slot_start, 1, frame);
+	}
+
+	int32_t phase(void) const { return (int32_t) (leader - follower); }
+
+	/* one frame, with or without the leader's slot */
+	void step(bool received) {
+		++frame;
+		leader += nominal + drift;
+		follower += pll.get_period();
+		pll.next_frame();
+		if (received) {
+			const int32_t n = noise ? std::rand() % (2*noise + 1) - noise : 0;
+			const int32_t l = late ? std::rand() % (late + 1) : 0;
+			const uint32_t timestamp = leader + slot_start + n + l;
+			pll.measure(timestamp - follower - slot_start, timestamp, 1, frame);
+		}
+		else
+			pll.holdover();
+	}
+};
+
+TEST_CASE( "frame timer locks to the leader", "[clocksync]" )
+{
+	Simulation sim(960000, 100, 0, 3000);
+
+	for (unsigned k = 0; k < 60; ++k)
+		sim.step(true);
+
+	REQUIRE( sim.pll.is_locked() );
+	REQUIRE( sim.pll.get_drift() == 100 );
+	REQUIRE( std::abs(sim.phase()) <= 2 );
+}
+
+TEST_CASE( "frame timer tracks a noisy leader", "[clocksync]" )
+{
+	std::srand(2026);
+	Simulation sim(960000, -57, 50, -2000);
+
+	for (unsigned k = 0; k < 100; ++k)
+		sim.step(true);
+	for (unsigned k = 0; k < 1000; ++k) {
+		sim.step(true);
+		REQUIRE( std::abs(sim.phase()) < 150 );
+	}
+	REQUIRE( std::abs(sim.pll.get_drift() + 57) < 20 );
+}
+
+TEST_CASE( "frame timer tolerates jittered time stamps", "[clocksync]" )
+{
+	/* time stamps late by up to two byte times at 3 Mbaud (640 cycles),
+	   see communication.hpp, the phase is biased by half of it */
+	std::srand(45);
+	Simulation sim(960000, 80, 0, 1500, 640);
+
+	for (unsigned k = 0; k < 100; ++k)
+		sim.step(true);
+
+	int32_t min_phase = 0, max_phase = -1000;
+	int64_t sum = 0;
+	for (unsigned k = 0; k < 2000; ++k) {
+		sim.step(true);
+		min_phase = std::min(min_phase, sim.phase());
+		max_phase = std::max(max_phase, sim.phase());
+		sum += sim.phase();
+	}
+	REQUIRE( std::abs(sum / 2000 + 320) < 40 );
+	REQUIRE( min_phase > -960 ); /* within half of the deadtime, no restart */
+	REQUIRE( max_phase < 320 );
+	REQUIRE( std::abs(sim.pll.get_drift() - 80) < 40 );
+	REQUIRE( sim.pll.is_locked() );
+}
+
+TEST_CASE( "frame timer holds over missed slots", "[clocksync]" )
+{
+	Simulation sim(960000, 200, 0, 0);
+	for (unsigned k = 0; k < 60; ++k)
+		sim.step(true);
+
+	for (unsigned k = 0; k < max_holdover; ++k) {
+		sim.step(false);
+		REQUIRE( sim.pll.is_locked() );
+		REQUIRE( std::abs(sim.phase()) <= 2 );
+	}
+	REQUIRE( sim.pll.get_missed() == max_holdover );
+
+	/* back again */
+	sim.step(true);
+	REQUIRE( sim.pll.get_missed() == 0 );
+
+	for (unsigned k = 0; k <= max_holdover; ++k)
+		sim.step(false);
+	REQUIRE_FALSE( sim.pll.is_locked() );
+	REQUIRE_FALSE( sim.pll.holdover() );
+}
+
+TEST_CASE( "leading board runs on its own clock", "[clocksync]" )
+{
+	Pll pll(960000);
+	pll.lock(1000, 2, 0);
+	pll.measure(0, 1000 + 960100, 2, 1);
+	REQUIRE( pll.get_drift() == 100 );
+
+	REQUIRE( pll.lead() == 960000 );
+	REQUIRE_FALSE( pll.is_locked() );
+	REQUIRE( pll.get_drift() == 0 );
+	REQUIRE( pll.next_frame() == 960000 );
+}
+
+} /* namespace local_tests */
+} /* namespace supreme */
@@ -1,27 +1,260 @@
-//#include <system/communication.hpp>
-#include <xpcc/architecture/platform.hpp>
-#include "./catch_1.10.0.hpp"
+#include <cstdint>
+#include <vector>
+#include <src/common.hpp>
+#include <src/ux_com.hpp>
+#include <src/communication.hpp>
+#include <src/setpoints.hpp>
+
+namespace supreme {
 
+	/* as in common.cpp, but faults are recorded only, never halt */
+	FaultLog_t fault_log;
+	faults::Policy fault(uint8_t code) { return fault_log.record(code, cyclecounter::now()); }
+	void assert(bool condition, uint8_t code) { if (not condition) fault(code); }
+	void error_state(void) { assert(false, 0); }
+
+} /* namespace supreme */
+
+#include "./catch_1.10.0.hpp"
 
 namespace supreme {
 namespace local_tests {
 
+/* the timer's interrupt is simulated by the tests, setting the timeout flag */
+struct TimerStub {
+	enum class Mode { UpCounter };
+	enum class Interrupt { Update };
 
-/*
-template <typename T>
-bool verify_checksum(T const& data) {
+	static inline bool running = false;
+
+	static void enable(void) {}
+	static void setMode(Mode) {}
+	template <typename Clock> static void setPeriod(unsigned) {}
+	static void enableInterruptVector(bool, unsigned) {}
+	static void enableInterrupt(Interrupt) {}
+	static void applyAndReset(void) {}
+	static void start(void) { running = true; }
+	static void pause(void) { running = false; }
+};
+
+template <typename Uart>
+void receive(std::vector<uint8_t> msg) {
 	uint8_t sum = 0;
-	for (auto const& d : data)
-		sum += d;
-	return sum == 0;
+	for (auto b: msg) sum += b;
+	msg.push_back(~sum + 1);
+	for (auto b: msg) Uart::rx.push_back(b);
 }
-*/
 
-TEST_CASE( "fofo", "[communication]")
+TEST_CASE( "motor response is accepted when the timer expires after its last byte", "[communication]")
 {
-    REQUIRE( true );
+	typedef Board::rs485_motorcord Motorcord_t;
+	Motorcord_t::uart::clear();
+	ux_communication_ctrl<Motorcord_t, TimerStub> motor(5);
+	motor.set_discovered();
+	const uint32_t faults_before = fault_log.get_count();
+
+	volatile bool timed_out = false;
+	REQUIRE_FALSE( motor.step(&timed_out) ); /* request sent */
+	REQUIRE( motor.get_connection_status() == request_pending );
+	REQUIRE( TimerStub::running );
+	REQUIRE( Motorcord_t::uart::tx.size() == 6 );
+	REQUIRE( Motorcord_t::uart::tx[2] == 0xB0 );
+
+	/* state response 0x80, position 0x1234 */
+	std::vector<uint8_t> response = { 0xFF, 0xFF, 0x80, 5, 0x12, 0x34 };
+	response.resize(24, 0);
+	receive<Motorcord_t::uart>(response);
+	REQUIRE_FALSE( motor.step(&timed_out) );
+	REQUIRE( motor.get_connection_status() == responded );
+
+	SECTION( "in time" ) {
+		REQUIRE( motor.step(&timed_out) );
+	}
+	SECTION( "timer expired before it was paused" ) {
+		timed_out = true;
+		REQUIRE( motor.step(&timed_out) );
+	}
+	REQUIRE( motor.get_connection_status() == is_connected );
+	REQUIRE( motor.get_status_data().position == 0x1234 );
+	REQUIRE( motor.get_latency().get_samples() == 1 );
+	REQUIRE_FALSE( TimerStub::running );
+	REQUIRE( fault_log.get_count() == faults_before );
 }
 
+TEST_CASE( "motor without response times out", "[communication]")
+{
+	typedef Board::rs485_motorcord Motorcord_t;
+	Motorcord_t::uart::clear();
+	ux_communication_ctrl<Motorcord_t, TimerStub> motor(5);
+	motor.set_discovered();
+	const uint32_t faults_before = fault_log.get_count();
 
-}} /* namespace supreme::local_tests */
+	volatile bool timed_out = false;
+	REQUIRE_FALSE( motor.step(&timed_out) );
+	REQUIRE_FALSE( motor.step(&timed_out) ); /* nothing received */
+	REQUIRE( motor.get_connection_status() == request_pending );
+
+	timed_out = true;
+	REQUIRE( motor.step(&timed_out) );
+	REQUIRE( motor.get_connection_status() == not_connected );
+	REQUIRE( motor.get_latency().get_samples() == 0 );
+	REQUIRE( fault_log.get_count() == faults_before );
+}
+
+/* spinal cord slots */
+
+typedef Board::rs485_spinalcord::uart Spinalcord_t;
+typedef setpoints::Store<12> Setpoints_t;
+typedef CommunicationController<TimerStub, 0x55, 7, 112, 1140, Setpoints_t> Controller_t;
+
+const setpoints::Policy policy = { setpoints::hold, 0, 0 };
+
+std::vector<uint8_t> make_header(uint8_t board, uint8_t length, uint8_t frame, uint8_t num_motors) {
+	return { 0x55, 0x55, board, length, 1, 2, 3, 4, 5, frame, 7, num_motors };
+}
+
+void add_trailer(std::vector<uint8_t>& slot) {
+	for (uint8_t b: {0xA0, 0xA1, 0xA2, 0xA3}) /* slot table chunk */
+		slot.push_back(b);
+	uint8_t sum = 0;
+	for (auto b: slot) sum += b;
+	slot.push_back(~sum + 1);
+}
 
+std::vector<uint8_t> make_full_slot(uint8_t board, uint8_t num_motors) {
+	std::vector<uint8_t> slot = make_header(board, topology::slot_bytes(num_motors), 0, num_motors);
+	for (uint8_t m = 0; m < num_motors; ++m) {
+		slot.push_back(10 + m); /* id */
+		slot.push_back(4);      /* status */
+		for (uint8_t i = 0; i < 2 * telemetry::num_values; ++i)
+			slot.push_back(m * 100 + i);
+	}
+	add_trailer(slot);
+	return slot;
+}
+
+struct SlotSink {
+	std::vector<uint8_t>& data;
+	void add_byte(uint8_t b)  { data.push_back(b); }
+	void add_word(uint16_t w) { add_byte(w >> 8); add_byte(w & 0xff); }
+};
+
+std::vector<uint8_t> make_compact_slot(uint8_t board, uint8_t num_motors, uint8_t frame) {
+	std::vector<uint8_t> slot = make_header( board, telemetry::compact_slot_bytes(num_motors, frame), frame
+	                                       , num_motors | telemetry::compact_flag);
+	telemetry::Encoder<4> enc;
+	SlotSink sink = {slot};
+	telemetry::Sample s = {};
+	for (uint8_t m = 0; m < num_motors; ++m) {
+		s[0] = 1000 + m;
+		enc.encode(sink, frame, m, 10 + m, 4, s);
+	}
+	add_trailer(slot);
+	return slot;
+}
+
+/* feeds the bytes to the controller, true if a slot was read,
+   the slot is valid until the next call of read_slot() */
+bool feed_slot(Controller_t& com, std::vector<uint8_t> const& bytes) {
+	Spinalcord_t::rx.insert(Spinalcord_t::rx.end(), bytes.begin(), bytes.end());
+	for (unsigned i = 0; i < 4 * bytes.size() + 8; ++i)
+		if (com.read_slot()) return true;
+	return false;
+}
+
+TEST_CASE( "slots are read through the stubbed uart", "[communication]")
+{
+	Spinalcord_t::clear();
+	volatile bool timed_out = false;
+	Setpoints_t setpoints(policy);
+	Controller_t com(&timed_out, setpoints);
+
+	SECTION( "full format" ) {
+		const std::vector<uint8_t> slot = make_full_slot(3, 3);
+		REQUIRE( slot.size() == 107 );
+		REQUIRE( feed_slot(com, slot) );
+		REQUIRE( com.get_received_id() == 3 );
+		REQUIRE( com.get_length() == 107 );
+		for (unsigned i = 0; i < slot.size(); ++i)
+			REQUIRE( com.get()[i] == slot[i] );
+		REQUIRE( com.errors == 0 );
+	}
+
+	SECTION( "compact format is expanded" ) {
+		const std::vector<uint8_t> slot = make_compact_slot(2, 3, 0); /* key record of motor 0 */
+		REQUIRE( slot.size() == telemetry::compact_slot_bytes(3, 0) );
+		REQUIRE( feed_slot(com, slot) );
+		REQUIRE( com.get_received_id() == 2 );
+		REQUIRE( com.get_length() == topology::slot_bytes(3) );
+
+		auto const& out = com.get();
+		REQUIRE( out[3] == topology::slot_bytes(3) );
+		REQUIRE( out[telemetry::header_bytes-1] == 3 ); /* compact flag cleared */
+		REQUIRE( out[telemetry::header_bytes] == 10 );
+		REQUIRE( out[telemetry::header_bytes+1] == 4 ); /* valid, key flag cleared */
+		REQUIRE( (out[telemetry::header_bytes+2] << 8 | out[telemetry::header_bytes+3]) == 1000 );
+		REQUIRE( out[telemetry::header_bytes + telemetry::full_record + 1] == 0 ); /* no key record yet */
+		REQUIRE( out[com.get_length()-5] == 0xA0 ); /* slot table kept */
+
+		uint8_t sum = 0;
+		for (unsigned i = 0; i < com.get_length(); ++i) sum += out[i];
+		REQUIRE( sum == 0 );
+		REQUIRE( com.errors == 0 );
+	}
+
+	SECTION( "malformed slots are rejected" ) {
+		std::vector<uint8_t> slot;
+		SECTION( "too short" ) {
+			slot = make_full_slot(3, 0);
+			slot[3] = topology::slot_bytes(0) - 1;
+		}
+		SECTION( "too long" ) {
+			slot = make_full_slot(3, 3);
+			slot[3] = 113; /* exceeds BytesPerSlot */
+		}
+		SECTION( "wrong checksum" ) {
+			slot = make_full_slot(3, 3);
+			slot.back() += 1;
+		}
+		SECTION( "compact, wrong length" ) {
+			slot = make_compact_slot(3, 3, 0);
+			slot[3] += 1; /* one byte of the next slot included */
+			slot.back() -= 1;
+			slot.push_back(0);
+		}
+		REQUIRE_FALSE( feed_slot(com, slot) );
+		REQUIRE( com.errors >= 1 );
+
+		/* the next slot is read */
+		const uint8_t errors = com.errors;
+		Spinalcord_t::rx.clear();
+		REQUIRE( feed_slot(com, make_full_slot(4, 2)) );
+		REQUIRE( com.get_received_id() == 4 );
+		REQUIRE( com.errors == errors );
+	}
+}
+
+TEST_CASE( "transparent data is committed to the setpoints", "[communication]")
+{
+	Spinalcord_t::clear();
+	volatile bool timed_out = false;
+	Setpoints_t setpoints(policy);
+	Controller_t com(&timed_out, setpoints);
+
+	std::vector<uint8_t> frame = { 0x55, 0x55, 0xff };
+	for (uint8_t i = 0; i < 12; ++i) {
+		frame.push_back(0x10 + i);
+		frame.push_back(i);
+	}
+	uint8_t sum = 0;
+	for (auto b: frame) sum += b;
+	frame.push_back(~sum + 1);
+	REQUIRE( frame.size() == 3 + 2*12 + 1u ); /* TranspDataSize */
+
+	REQUIRE_FALSE( feed_slot(com, frame) ); /* not visible as slot */
+	REQUIRE( setpoints.is_fresh() );
+	for (uint8_t i = 0; i < 12; ++i)
+		REQUIRE( setpoints.get()[i] == ((0x10 + i) << 8 | i) );
+}
+
+}} /* namespace supreme::local_tests */
@@ -0,0 +1,135 @@
+#include <cstdint>
+#include <array>
+#include "./catch_1.10.0.hpp"
+#include <src/config.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+using namespace config;
+
+/* flash emulation, programming only clears bits */
+struct RamFlash {
+	static constexpr uint32_t size = 304; /* 4 records */
+	static std::array<uint32_t, size/4> mem;
+	static unsigned erase_count;
+	static unsigned fail_after; /* number of words programmed before power loss */
+
+	static uint8_t const* data(void) { return reinterpret_cast<uint8_t const*>(mem.data()); }
+
+	static bool erase(void) { mem.fill(0xFFFFFFFF); ++erase_count; return true; }
+
+	static bool program(uint32_t offset, uint32_t word) {
+		if (fail_after == 0) return false;
+		--fail_after;
+		mem[offset/4] &= word;
+		return true;
+	}
+
+	static void reset(void) { erase(); erase_count = 0; fail_after = 0xffff; }
+};
+
+std::array<uint32_t, RamFlash::size/4> RamFlash::mem;
+unsigned RamFlash::erase_count = 0;
+unsigned RamFlash::fail_after = 0xffff;
+
+typedef Store<RamFlash> Store_t;
+typedef slottable::Schedule<10, 20, 24> Schedule_t;
+
+Config make_config(uint8_t board_id) {
+	return { board_id, 0, topology::quadruped, slottable::make_fitted(100, 80, topology::quadruped)
+	       , { 10500, 9600, 5000 }, 36300, 10, {0,0,0} };
+}
+
+TEST_CASE( "config validation", "[config]")
+{
+	Config c = make_config(3);
+	REQUIRE( is_valid<Schedule_t>(c, 112, 12) );
+
+	c.board_id = 8;
+	REQUIRE_FALSE( is_valid<Schedule_t>(c, 112, 12) );
+
+	c = make_config(3);
+	c.flags = 0x20;
+	REQUIRE_FALSE( is_valid<Schedule_t>(c, 112, 12) );
+
+	c = make_config(3);
+	c.topology = topology::hexapod; /* exceeds slot and voltage size */
+	REQUIRE_FALSE( is_valid<Schedule_t>(c, 112, 12) );
+
+	c = make_config(3);
+	c.slots.num_slots = 0;
+	REQUIRE_FALSE( is_valid<Schedule_t>(c, 112, 12) );
+
+	c = make_config(3); /* compact telemetry allows shorter slots */
+	c.slots = slottable::make_fitted(100, 80, topology::quadruped, true);
+	REQUIRE_FALSE( is_valid<Schedule_t>(c, 112, 12) );
+	c.flags |= compact;
+	REQUIRE( is_valid<Schedule_t>(c, 112, 12) );
+	REQUIRE( c.is_compact() );
+	REQUIRE_FALSE( c.is_trunk() );
+
+	c = make_config(3); /* slot too short for board's motors */
+	c.slots.slots[2] = slottable::slot_entry(2, 64);
+	REQUIRE_FALSE( is_valid<Schedule_t>(c, 112, 12) );
+
+	c = make_config(3); /* derating thresholds out of order */
+	c.derating.min_mV = 10500;
+	REQUIRE_FALSE( is_valid<Schedule_t>(c, 112, 12) );
+	c.derating = { 10500, 9600, 9600 };
+	REQUIRE_FALSE( is_valid<Schedule_t>(c, 112, 12) );
+	c.derating = { 25000, 20000, 0 }; /* e.g. 6S pack */
+	REQUIRE( is_valid<Schedule_t>(c, 112, 12) );
+
+	c = make_config(3);
+	c.ain_full_scale_mV = 0;
+	REQUIRE_FALSE( is_valid<Schedule_t>(c, 112, 12) );
+}
+
+TEST_CASE( "config is stored as log in flash", "[config]")
+{
+	RamFlash::reset();
+	REQUIRE( Store_t::load() == nullptr );
+
+	REQUIRE( Store_t::store(make_config(1)) );
+	REQUIRE( Store_t::load() != nullptr );
+	REQUIRE( Store_t::load()->board_id == 1 );
+	REQUIRE( Store_t::get_num_records() == 1 );
+
+	/* unchanged config is not written again */
+	REQUIRE( Store_t::store(make_config(1)) );
+	REQUIRE( Store_t::get_num_records() == 1 );
+
+	REQUIRE( Store_t::store(make_config(2)) );
+	REQUIRE( Store_t::store(make_config(3)) );
+	REQUIRE( Store_t::store(make_config(5)) );
+	REQUIRE( Store_t::get_num_records() == 4 );
+	REQUIRE( Store_t::load()->board_id == 5 );
+	REQUIRE( RamFlash::erase_count == 0 );
+
+	/* sector full, erased and started over */
+	REQUIRE( Store_t::store(make_config(6)) );
+	REQUIRE( RamFlash::erase_count == 1 );
+	REQUIRE( Store_t::get_num_records() == 1 );
+	REQUIRE( Store_t::load()->board_id == 6 );
+	REQUIRE( Store_t::load()->slots.frame_100us == 100 );
+}
+
+TEST_CASE( "interrupted write keeps the former config", "[config]")
+{
+	RamFlash::reset();
+	REQUIRE( Store_t::store(make_config(2)) );
+
+	RamFlash::fail_after = 10; /* power loss while programming */
+	REQUIRE_FALSE( Store_t::store(make_config(4)) );
+	REQUIRE( Store_t::get_num_records() == 2 );
+	REQUIRE( Store_t::load()->board_id == 2 );
+
+	/* next write goes behind the broken record */
+	RamFlash::fail_after = 0xffff;
+	REQUIRE( Store_t::store(make_config(4)) );
+	REQUIRE( Store_t::get_num_records() == 3 );
+	REQUIRE( Store_t::load()->board_id == 4 );
+}
+
+}} // namespace supreme::local_tests
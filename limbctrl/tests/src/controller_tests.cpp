@@ -0,0 +1,164 @@
+#include <cstdint>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "./catch_1.10.0.hpp"
+#include <src/controller.hpp>
+#include <src/cpg.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+using namespace controller;
+
+namespace {
+	float random_weight(void) { return (std::rand() % 2001 - 1000) / 1000.f; }
+}
+
+TEST_CASE( "tanh approximation", "[controller]" )
+{
+	for (float x = -8.f; x <= 8.f; x += 0.001f)
+		REQUIRE( std::abs(controller::tanh(x) - std::tanh(x)) < 1e-4 );
+
+	REQUIRE( controller::tanh(0.f) == 0.f );
+	REQUIRE( controller::tanh( 100.f) ==  1.f );
+	REQUIRE( controller::tanh(-100.f) == -1.f );
+}
+
+TEST_CASE( "recurrent network matches reference implementation", "[controller]" )
+{
+	constexpr unsigned I = 9, H = 4, O = 3;
+	typedef Params<I,H,O> Params_t;
+
+	std::srand(4711);
+	static Params_t p;
+	for (auto& r: p.W) for (auto& w: r) w = random_weight();
+	for (auto& r: p.U) for (auto& w: r) w = random_weight();
+	for (auto& r: p.V) for (auto& w: r) w = random_weight();
+	for (auto& w: p.b ) w = random_weight();
+	for (auto& w: p.h0) w = random_weight();
+
+	RecurrentNetwork<I,H,O> net(p);
+
+	/* reference in double precision */
+	std::vector<double> h(p.h0, p.h0 + H), a(H);
+
+	for (unsigned t = 0; t < 1000; ++t) {
+		std::array<float, I> x;
+		for (auto& xi: x) xi = random_weight();
+
+		for (unsigned j = 0; j < H; ++j) {
+			a[j] = p.b[j];
+			for (unsigned i = 0; i < I; ++i) a[j] += p.W[j][i] * (double) x[i];
+			for (unsigned k = 0; k < H; ++k) a[j] += p.U[j][k] * h[k];
+		}
+		for (unsigned j = 0; j < H; ++j) h[j] = std::tanh(a[j]);
+
+		net.step(x);
+
+		for (unsigned j = 0; j < H; ++j)
+			REQUIRE( std::abs(net.get_state()[j] - h[j]) < 1e-3 );
+
+		for (unsigned k = 0; k < O; ++k) {
+			double y = 0.0;
+			for (unsigned j = 0; j < H; ++j) y += p.V[k][j] * h[j];
+			REQUIRE( std::abs(net.output(k) - y) < 1e-3 );
+		}
+	}
+	REQUIRE( net.output(O) == 0.f );
+
+	net.reset();
+	for (unsigned j = 0; j < H; ++j)
+		REQUIRE( net.get_state()[j] == p.h0[j] );
+}
+
+TEST_CASE( "sensor inputs are read from full format slots", "[controller]" )
+{
+	typedef std::array<uint8_t, 112> Slot;
+	SensorInputs<12> sensors;
+
+	Slot slot = {};
+	const uint8_t n = 2;
+	const unsigned length = telemetry::header_bytes + n * telemetry::full_record + telemetry::trailer_bytes;
+	slot[0] = slot[1] = 0x55;
+	slot[2] = 1;
+	slot[3] = length;
+	slot[telemetry::header_bytes-1] = n;
+
+	const uint8_t  ids[n] = {4, 5};
+	const uint8_t  status[n] = {4, 0};
+	const uint16_t pos[n] = {49152, 16384}; /* Q6 */
+	const int16_t  cur[n] = {-1024, 100}, vel[n] = {128, 7};
+	for (uint8_t m = 0; m < n; ++m) {
+		const unsigned p = telemetry::header_bytes + m * telemetry::full_record;
+		slot[p]   = ids[m];
+		slot[p+1] = status[m];
+		slot[p+2] = pos[m] >> 8;            slot[p+3] = pos[m] & 0xff;
+		slot[p+4] = (uint16_t) cur[m] >> 8; slot[p+5] = cur[m] & 0xff;
+		slot[p+6] = (uint16_t) vel[m] >> 8; slot[p+7] = vel[m] & 0xff;
+	}
+
+	sensors.read_slot(slot, length);
+	auto const& x = sensors.get();
+	REQUIRE( x[4*channels+0] ==  0.5f );
+	REQUIRE( x[4*channels+1] ==  0.125f );
+	REQUIRE( x[4*channels+2] == -1.0f );
+	for (unsigned c = 0; c < channels; ++c)
+		REQUIRE( x[5*channels+c] == 0.f ); /* not connected */
+
+	/* position is centred, full range maps to [-1,+1) */
+	sensors.set(4, true, 0, 0, 0);
+	REQUIRE( x[4*channels+0] == -1.0f );
+	sensors.set(4, true, 32768, 0, 0);
+	REQUIRE( x[4*channels+0] ==  0.0f );
+	sensors.set(4, true, 1023 << 6, 0, 0);
+	REQUIRE( x[4*channels+0] >  0.99f );
+	REQUIRE( x[4*channels+0] <  1.0f );
+
+	/* a new frame starts without inputs */
+	sensors.clear();
+	for (auto v: sensors.get())
+		REQUIRE( v == 0.f );
+
+	/* wrong length and compact slots are ignored */
+	SensorInputs<12> other;
+	other.read_slot(slot, length - 1);
+	slot[telemetry::header_bytes-1] |= telemetry::compact_flag;
+	other.read_slot(slot, length);
+	for (auto v: other.get())
+		REQUIRE( v == 0.f );
+}
+
+TEST_CASE( "example CPG oscillates", "[controller]" )
+{
+	RecurrentNetwork<36,2,12> cpg(quadruped_cpg);
+	std::array<float, 36> x = {};
+
+	float max_y = 0.f, min_y = 0.f;
+	unsigned sign_changes = 0;
+	float last = cpg.output(0);
+
+	for (unsigned t = 0; t < 1000; ++t) {
+		cpg.step(x);
+		const float y = cpg.output(0);
+		REQUIRE( std::abs(y) <= cpg_amp );
+		REQUIRE( cpg.output(7) ==  y );
+		REQUIRE( cpg.output(1) == -y );
+		REQUIRE( cpg.output(6) == -y );
+		REQUIRE( cpg.output(2) == 0.f );
+		if (t > 200) { /* transient */
+			max_y = std::max(max_y, y);
+			min_y = std::min(min_y, y);
+		}
+		if ((y > 0) != (last > 0)) ++sign_changes;
+		last = y;
+	}
+	/* approx. 1 period per 100 frames */
+	REQUIRE( sign_changes >= 15 );
+	REQUIRE( sign_changes <= 25 );
+	REQUIRE( max_y >  0.1f );
+	REQUIRE( min_y < -0.1f );
+}
+
+} /* namespace local_tests */
+} /* namespace supreme */
@@ -0,0 +1,44 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/cpuload.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "cpu load is accounted per state and published per window", "[cpuload]" )
+{
+	CpuLoad<3> load;
+	REQUIRE( load.get_load() == 0 );
+
+	/* nothing is accounted before the first mark */
+	load.mark(0, 1000);
+	load.mark(1, 1100);  /* 100 in state 0 */
+	load.mark(1, 1300);  /* 200 in state 1 */
+	load.slept(1700);    /* 400 asleep */
+	load.mark(2, 1750);  /* 50 in state 1 */
+	load.slept(1800);    /* 50 asleep */
+	load.mark(0, 1850);  /* 50 in state 2 */
+
+	/* not yet published */
+	for (uint8_t frame = 1; frame != 0; ++frame)
+		load.next_frame(frame);
+	REQUIRE( load.get_busy(0) == 0 );
+	REQUIRE( load.get_sleep() == 0 );
+
+	load.next_frame(0);
+	REQUIRE( load.get_busy(0) == 100 );
+	REQUIRE( load.get_busy(1) == 250 );
+	REQUIRE( load.get_busy(2) ==  50 );
+	REQUIRE( load.get_busy(3) ==   0 ); /* no such state */
+	REQUIRE( load.get_sleep() == 450 );
+	REQUIRE( load.get_load() == 400 * 256 / 850 );
+
+	/* next window, counter wraps around */
+	load.slept(0xffffff00);
+	load.mark(1, 0x00000100); /* 0x200 in state 0 */
+	load.next_frame(0);
+	REQUIRE( load.get_busy(0) == 0x200 );
+	REQUIRE( load.get_busy(1) == 0 );
+}
+
+}} // namespace supreme::local_tests
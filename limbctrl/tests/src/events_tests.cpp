@@ -0,0 +1,34 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/events.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "events are merged until taken", "[events]" )
+{
+	EventQueue q;
+	REQUIRE( q.empty() );
+	REQUIRE_FALSE( q.take(0x1) );
+
+	q.post(0x1);
+	q.post(0x1);
+	q.post(0x4);
+	REQUIRE_FALSE( q.empty() );
+
+	REQUIRE_FALSE( q.take(0x2) );
+	REQUIRE( q.take(0x1) );
+	REQUIRE_FALSE( q.take(0x1) ); /* merged, taken once */
+	REQUIRE_FALSE( q.empty() );
+
+	/* any of several */
+	REQUIRE( q.take(0x6) );
+	REQUIRE( q.empty() );
+
+	q.post(0x3);
+	REQUIRE( q.take(0x1) );
+	REQUIRE( q.take(0x2) ); /* others are kept */
+	REQUIRE( q.empty() );
+}
+
+}} // namespace supreme::local_tests
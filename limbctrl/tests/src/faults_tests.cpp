@@ -0,0 +1,79 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/faults.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "fault policies", "[faults]" )
+{
+	/* unexpected motor responses must not halt the board */
+	for (uint8_t code: {3, 4, 27, 55})
+		REQUIRE( faults::policy(code) == faults::proceed );
+	for (uint8_t code: {17, 76, 78, 79})
+		REQUIRE( faults::policy(code) == faults::reset );
+	/* buffer bounds, config, duplicate id */
+	for (uint8_t code: {0, 1, 6, 8, 9, 11, 16, 18, 19, 20, 21})
+		REQUIRE( faults::policy(code) == faults::halt );
+
+	faults::Log<4> log;
+	REQUIRE( log.record(78, 100) == faults::reset );
+	log.set_halt_all(true);
+	REQUIRE( log.record(3, 200) == faults::halt );
+}
+
+TEST_CASE( "fault log keeps the latest faults and reports them", "[faults]" )
+{
+	faults::Log<4> log;
+	REQUIRE( log.size() == 0 );
+
+	log.set_state(5);
+	log.set_frame(42);
+	REQUIRE( log.record(78, 1000) == faults::reset );
+	REQUIRE( log.size() == 1 );
+	REQUIRE( log.get(0).code  == 78 );
+	REQUIRE( log.get(0).time  == 1000 );
+	REQUIRE( log.get(0).state == 5 );
+	REQUIRE( log.get(0).frame == 42 );
+
+	for (uint8_t i = 0; i < 5; ++i) {
+		log.set_frame(43 + i);
+		log.record(3, 2000 + i);
+	}
+	log.set_state(6);
+	log.record(17, 3000);
+	REQUIRE( log.size() == 4 );
+	REQUIRE( log.get_count() == 7 );
+	REQUIRE( log.get_resets() == 2 );
+	REQUIRE( log.get(0).code == 17 ); /* latest first */
+	REQUIRE( log.get(1).time == 2004 );
+	REQUIRE( log.get(3).time == 2002 );
+
+	/* published at frame % 64 == 16 only */
+	for (unsigned f = 0; f < 16; ++f) {
+		log.next_frame(f);
+		REQUIRE( log.get_byte(f) == 0 );
+	}
+	log.next_frame(16);
+	REQUIRE( log.get_byte(16) == 0 ); /* count, MSB */
+	REQUIRE( log.get_byte(17) == 7 );
+	REQUIRE( log.get_byte(18) == 2 );
+	REQUIRE( log.get_byte(19) == 17 ); /* code, state, frame */
+	REQUIRE( log.get_byte(20) == 6 );
+	REQUIRE( log.get_byte(21) == 47 );
+	REQUIRE( log.get_byte(22) == 3 );
+	REQUIRE( log.get_byte(24) == 47 );
+	REQUIRE( log.get_byte(31) == 0 );
+
+	/* stays consistent while it is sent */
+	log.record(4, 4000);
+	log.next_frame(17);
+	REQUIRE( log.get_byte(17) == 7 );
+	log.next_frame(48);
+	REQUIRE( log.get_byte(17) == 7 );
+	log.next_frame(80);
+	REQUIRE( log.get_byte(17) == 8 );
+	REQUIRE( log.get_byte(19) == 4 );
+}
+
+}} // namespace supreme::local_tests
@@ -0,0 +1,123 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/health.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+const health::Derating derating = { 10500, 9600, 5000 };
+
+TEST_CASE( "pwm limit is derated under low supply voltage", "[health]" )
+{
+	REQUIRE( health::derate(128, 12000, derating) == 128 );
+	REQUIRE( health::derate(128, 10500, derating) == 128 );
+	REQUIRE( health::derate(128, 10400, derating) == 112 );
+	REQUIRE( health::derate(128, 10050, derating) ==  80 );
+	REQUIRE( health::derate(128,  9600, derating) ==  32 );
+	REQUIRE( health::derate(128,  7000, derating) ==  32 );
+
+	/* not measured, e.g. bench supply */
+	REQUIRE( health::derate(128, 0   , derating) == 128 );
+	REQUIRE( health::derate(128, 4999, derating) == 128 );
+
+	/* monotonic, quantized, never below 1/4 */
+	uint8_t last = 32;
+	for (uint16_t mV = 5000; mV <= 11000; mV += 10) {
+		const uint8_t l = health::derate(128, mV, derating);
+		REQUIRE( l >= last );
+		REQUIRE( l >= 32 );
+		REQUIRE( (l % 8 == 0) );
+		last = l;
+	}
+
+	REQUIRE( health::to_mV(4095, 3300 * 11) == 36300 );
+	REQUIRE( health::to_mV(   0, 3300 * 11) ==     0 );
+}
+
+TEST_CASE( "board health filters the readings and reports them", "[health]" )
+{
+	health::Monitor monitor(128, derating);
+	REQUIRE( monitor.get_pwm_limit() == 128 ); /* not yet measured */
+
+	monitor.update(12000, 12100, true);
+	REQUIRE( monitor.get_supply_mV()  == 12000 ); /* first reading */
+	REQUIRE( monitor.get_battery_mV() == 12100 );
+	REQUIRE( monitor.get_status() );
+
+	monitor.update(10000, 12100, false);
+	REQUIRE( monitor.get_supply_mV() == 11500 );
+	REQUIRE( monitor.get_pwm_limit() == 128 );
+
+	for (unsigned i = 0; i < 50; ++i)
+		monitor.update(10000, 12100, false);
+	REQUIRE( monitor.get_supply_mV() == 10000 );
+	REQUIRE( monitor.get_pwm_limit() ==    72 );
+
+	/* published at frame % 64 == 48 only */
+	for (unsigned f = 0; f < 48; ++f) {
+		monitor.next_frame(f);
+		REQUIRE( monitor.get_byte(f) == 0 );
+	}
+	monitor.next_frame(48);
+	REQUIRE( monitor.get_byte(48) == (10000 >> 8) ); /* supply, MSB */
+	REQUIRE( monitor.get_byte(49) == (10000 & 0xff) );
+	REQUIRE( monitor.get_byte(50) == (12100 >> 8) ); /* battery */
+	REQUIRE( monitor.get_byte(51) == (12100 & 0xff) );
+	REQUIRE( monitor.get_byte(52) == (10000 >> 8) ); /* min. supply */
+	REQUIRE( monitor.get_byte(53) == (10000 & 0xff) );
+	REQUIRE( monitor.get_byte(54) == 0 ); /* status pin */
+	REQUIRE( monitor.get_byte(55) == 72 ); /* pwm limit */
+	REQUIRE( monitor.get_byte(63) == 0 );
+
+	/* stays consistent while it is sent, min. restarts with each record */
+	for (unsigned i = 0; i < 50; ++i)
+		monitor.update(12000, 12100, true);
+	monitor.next_frame(49);
+	REQUIRE( monitor.get_byte(55) == 72 );
+	monitor.next_frame(112);
+	REQUIRE( monitor.get_byte(55) == 128 );
+	REQUIRE( monitor.get_byte(54) == 1 );
+	REQUIRE( monitor.get_byte(52) == (10500 >> 8) ); /* second update: 10500 */
+	REQUIRE( monitor.get_byte(53) == (10500 & 0xff) );
+}
+
+TEST_CASE( "pwm limit changes with hysteresis", "[health]" )
+{
+	health::Monitor monitor(128, derating);
+
+	/* slow noise around the threshold of the step from 104 to 112 (10350 mV) */
+	for (unsigned i = 0; i < 50; ++i)
+		monitor.update(10300, 12000, true);
+	REQUIRE( monitor.get_pwm_limit() == 104 );
+
+	unsigned changes = 0;
+	uint8_t last = monitor.get_pwm_limit();
+	for (unsigned i = 0; i < 1000; ++i) {
+		monitor.update(10350 + ((i / 10 % 2) ? 40 : -40), 12000, true);
+		changes += (monitor.get_pwm_limit() != last);
+		last = monitor.get_pwm_limit();
+	}
+	REQUIRE( changes == 0 );
+
+	/* lowered at once, raised only hysteresis_mV above the threshold (88: 10125 mV) */
+	for (unsigned i = 0; i < 50; ++i)
+		monitor.update(10050, 12000, true);
+	REQUIRE( monitor.get_pwm_limit() == 80 );
+	for (unsigned i = 0; i < 50; ++i)
+		monitor.update(10125 + health::hysteresis_mV - 10, 12000, true);
+	REQUIRE( monitor.get_pwm_limit() == 80 );
+	for (unsigned i = 0; i < 50; ++i)
+		monitor.update(10125 + health::hysteresis_mV, 12000, true);
+	REQUIRE( monitor.get_pwm_limit() == 80 + 8 );
+
+	/* new thresholds, e.g. from the config */
+	monitor.set_derating({ 10000, 9000, 5000 });
+	monitor.update(10150, 12000, true);
+	REQUIRE( monitor.get_pwm_limit() == 128 );
+
+	REQUIRE( health::is_valid(derating) );
+	REQUIRE_FALSE( health::is_valid({ 9600, 10500, 5000 }) );
+	REQUIRE_FALSE( health::is_valid({ 0xffff, 9600, 5000 }) );
+}
+
+}} // namespace supreme::local_tests
@@ -0,0 +1,55 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/leader.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "lowest id of board list", "[leader]" )
+{
+	REQUIRE( lowest_id(0x00) == 0xff );
+	REQUIRE( lowest_id(0x01) == 0 );
+	REQUIRE( lowest_id(0x0C) == 2 );
+	REQUIRE( lowest_id(0x80) == 7 );
+}
+
+TEST_CASE( "lowest board heard in the last frame leads", "[leader]" )
+{
+	LeaderElection e(3);
+	e.begin(0x00); /* nothing heard */
+	REQUIRE( e.get_leader() == 3 );
+	REQUIRE( e.we_lead() );
+
+	e.begin(0x3A); /* boards 1,3,4,5 */
+	REQUIRE( e.get_leader() == 1 );
+	REQUIRE_FALSE( e.we_lead() );
+
+	LeaderElection f(0);
+	f.begin(0x3A);
+	REQUIRE( f.we_lead() );
+}
+
+TEST_CASE( "next lowest board takes over", "[leader]" )
+{
+	/* boards 1,2,4,5 heard, 1 and 2 unplugged */
+	LeaderElection a(4), b(5);
+	a.begin(0x36);
+	b.begin(0x36);
+	REQUIRE( a.get_leader() == 1 );
+	REQUIRE( a.failover() == 2 );
+	REQUIRE( b.failover() == 2 );
+	REQUIRE( a.failover() == 4 );
+	REQUIRE( b.failover() == 4 );
+	REQUIRE( a.we_lead() );
+	REQUIRE_FALSE( b.we_lead() );
+
+	/* own board is never removed */
+	REQUIRE( a.failover() == 4 );
+
+	/* next frame, without the unplugged boards */
+	b.begin(0x30);
+	REQUIRE( b.get_leader() == 4 );
+}
+
+} /* namespace local_tests */
+} /* namespace supreme */
@@ -0,0 +1,91 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/polling.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "latency stats track min, max and average", "[polling]")
+{
+	LatencyStats l;
+	REQUIRE( l.get_samples() == 0 );
+	REQUIRE( l.get_timeout(50, 500) == 500 );
+
+	l.add(100);
+	REQUIRE( l.get_min() == 100 );
+	REQUIRE( l.get_max() == 100 );
+	REQUIRE( l.get_avg() == 100 );
+
+	l.add( 80);
+	l.add(120);
+	REQUIRE( l.get_min() ==  80 );
+	REQUIRE( l.get_max() == 120 );
+
+	/* average converges */
+	for (unsigned i = 0; i < 200; ++i)
+		l.add(90);
+	REQUIRE( l.get_avg() >= 89 );
+	REQUIRE( l.get_avg() <= 90 );
+}
+
+TEST_CASE( "response timeout adapts after enough samples with a margin of the spread", "[polling]")
+{
+	LatencyStats l;
+
+	/* default until enough samples were measured */
+	for (unsigned i = 1; i < LatencyStats::min_samples; ++i) {
+		l.add(100);
+		REQUIRE( l.get_timeout(50, 500) == 500 );
+	}
+	l.add(100);
+	REQUIRE( l.get_timeout(50, 500) == 150 ); /* min. margin */
+
+	/* margin grows with the spread */
+	l.add( 60);
+	l.add(180);
+	REQUIRE( l.get_timeout(50, 500) == 300 ); /* 180 + (180 - 60) */
+
+	/* limited by default */
+	l.add(300);
+	REQUIRE( l.get_timeout(50, 500) == 500 );
+}
+
+TEST_CASE( "a single timeout does not discard the latency statistics", "[polling]")
+{
+	LatencyStats l;
+	for (unsigned i = 0; i < LatencyStats::min_samples; ++i)
+		l.add(100 + i % 4);
+	REQUIRE( l.get_timeout(50, 500) == 153 );
+
+	/* jitter spike: the next request waits with the default timeout ... */
+	l.timed_out();
+	REQUIRE( l.get_samples() == LatencyStats::min_samples );
+	REQUIRE( l.get_timeout(50, 500) == 500 );
+
+	/* ... and the late response widens the margin */
+	l.add(200);
+	REQUIRE( l.get_timeout(50, 500) == 300 );
+	REQUIRE( l.get_samples() == LatencyStats::min_samples + 1 );
+}
+
+TEST_CASE( "backoff skips exponentially more polls after failures", "[polling]")
+{
+	Backoff<3> b;
+	REQUIRE( b.poll_now() );
+	REQUIRE( b.poll_now() );
+
+	unsigned expected_skips[] = { 1, 3, 7, 7 };
+	for (unsigned skips : expected_skips) {
+		b.failed();
+		for (unsigned i = 0; i < skips; ++i)
+			REQUIRE( not b.poll_now() );
+		REQUIRE( b.poll_now() );
+	}
+	REQUIRE( b.get_exponent() == 3 );
+
+	b.succeeded();
+	REQUIRE( b.get_exponent() == 0 );
+	REQUIRE( b.poll_now() );
+}
+
+}} /* namespace supreme::local_tests */
@@ -0,0 +1,80 @@
+#include <cstdint>
+#include <vector>
+#include "./catch_1.10.0.hpp"
+#include <src/robotstate.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+typedef RobotState<8, 32> RobotState_t;
+
+std::vector<uint8_t> make_slot(uint8_t board, uint8_t length) {
+	std::vector<uint8_t> s(length, board + 0x10);
+	s[0] = s[1] = 0x55;
+	s[2] = board;
+	s[3] = length;
+	return s;
+}
+
+TEST_CASE( "robot state frame aggregates slots", "[robotstate]" )
+{
+	RobotState_t state;
+	REQUIRE_FALSE( state.is_open() );
+	REQUIRE_FALSE( state.add(make_slot(0, 17), 17) ); /* not begun */
+
+	state.begin(42);
+	REQUIRE( state.is_open() );
+	REQUIRE( state.add(make_slot(3, 17), 17) );
+	REQUIRE( state.add(make_slot(1, 32), 32) );
+	REQUIRE_FALSE( state.add(make_slot(3, 17), 17) ); /* duplicate */
+	REQUIRE_FALSE( state.add(make_slot(8, 17), 17) ); /* invalid id */
+	REQUIRE_FALSE( state.add(make_slot(2, 33), 33) ); /* too long */
+	state.finish();
+	REQUIRE_FALSE( state.is_open() );
+	REQUIRE_FALSE( state.add(make_slot(5, 17), 17) ); /* finished */
+
+	const unsigned len = RobotState_t::header_bytes + 17 + 32 + 1;
+	uint8_t const* f = state.get();
+	REQUIRE( state.get_length() == len );
+	REQUIRE( f[0] == 0x55 );
+	REQUIRE( f[1] == 0x55 );
+	REQUIRE( f[2] == RobotState_t::frame_id );
+	REQUIRE( (f[3] << 8 | f[4]) == len );
+	REQUIRE( f[5] == 42 );
+	REQUIRE( f[6] == 0x0A ); /* boards 1 and 3 */
+	REQUIRE( state.get_valid() == 0x0A );
+	REQUIRE( f[7] == 2 );
+
+	/* slots in order of reception */
+	REQUIRE( f[8+2] == 3 );
+	REQUIRE( f[8+3] == 17 );
+	REQUIRE( f[8+17+2] == 1 );
+	REQUIRE( f[8+17+31] == 0x11 );
+
+	uint8_t sum = 0;
+	for (unsigned i = 0; i < len; ++i) sum += f[i];
+	REQUIRE( sum == 0 );
+}
+
+TEST_CASE( "robot state frame may hold all boards", "[robotstate]" )
+{
+	RobotState_t state;
+	for (uint8_t frame = 0; frame < 3; ++frame) {
+		state.begin(frame);
+		for (uint8_t b = 0; b < 8; ++b)
+			REQUIRE( state.add(make_slot(b, 32), 32) );
+		state.finish();
+		REQUIRE( state.get_length() == RobotState_t::max_bytes );
+		REQUIRE( state.get_valid() == 0xFF );
+		REQUIRE( state.get()[7] == 8 );
+	}
+
+	/* empty frame */
+	state.begin(7);
+	state.finish();
+	REQUIRE( state.get_length() == RobotState_t::header_bytes + 1 );
+	REQUIRE( state.get_valid() == 0 );
+}
+
+} /* namespace local_tests */
+} /* namespace supreme */
@@ -0,0 +1,102 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/setpoints.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+using namespace setpoints;
+
+typedef Store<4> Store_t;
+
+void write(Store_t& s, scdata_t value) {
+	auto& v = s.begin_write();
+	v.fill(value);
+	s.commit();
+}
+
+TEST_CASE( "setpoints are double buffered", "[setpoints]" )
+{
+	Store_t s({hold, 0, 0});
+	REQUIRE_FALSE( s.is_fresh() );
+	REQUIRE( s.get_age() == Store_t::max_age );
+
+	s.next_frame(1);
+	write(s, 100);
+	REQUIRE( s.is_fresh() );
+	REQUIRE( s.get_fresh_since() == 1 );
+
+	/* uncommitted writes are not visible */
+	auto& v = s.begin_write();
+	REQUIRE( v[0] == 100 );
+	v.fill(200);
+	for (auto x: s.get()) REQUIRE( x == 100 );
+	s.commit();
+	for (auto x: s.get()) REQUIRE( x == 200 );
+
+	/* partial writes keep the other setpoints */
+	s.begin_write()[2] = 7;
+	s.commit();
+	REQUIRE( s.get()[1] == 200 );
+	REQUIRE( s.get()[2] == 7 );
+}
+
+TEST_CASE( "setpoint policies", "[setpoints]" )
+{
+	SECTION( "zero clears after hold frames" ) {
+		Store_t s({zero, 0, 0});
+		s.next_frame(1);
+		write(s, 100);
+		REQUIRE( s.get()[0] == 100 ); /* used once */
+		s.next_frame(2);
+		REQUIRE_FALSE( s.is_fresh() );
+		REQUIRE( s.get_age() == 1 );
+		REQUIRE( s.get()[0] == 0 );
+	}
+
+	SECTION( "hold keeps last value" ) {
+		Store_t s({hold, 0, 0});
+		s.next_frame(1);
+		write(s, 0x8000 | 500);
+		for (unsigned f = 2; f < 600; ++f) {
+			s.next_frame(f);
+			REQUIRE( s.get()[3] == (0x8000 | 500) );
+		}
+		REQUIRE( s.get_age() == Store_t::max_age );
+		REQUIRE( s.get_fresh_since() == 1 );
+	}
+
+	SECTION( "decay after hold frames" ) {
+		Store_t s({decay, 2, 1});
+		s.next_frame(10);
+		write(s, 0x8000 | 1024);
+		s.next_frame(11);
+		s.next_frame(12);
+		REQUIRE( s.get()[0] == (0x8000 | 1024) );
+		s.next_frame(13);
+		REQUIRE( s.get()[0] == (0x8000 | 512) ); /* sign is kept */
+		s.next_frame(14);
+		REQUIRE( s.get()[0] == (0x8000 | 256) );
+		for (unsigned f = 15; f < 30; ++f)
+			s.next_frame(f);
+		REQUIRE( s.get()[0] == 0 );
+
+		/* fresh setpoints stop the decay */
+		write(s, 300);
+		s.next_frame(30);
+		REQUIRE( s.get()[0] == 300 );
+	}
+}
+
+TEST_CASE( "decayed spinalcord data", "[setpoints]" )
+{
+	REQUIRE( decayed(0, 2) == 0 );
+	REQUIRE( decayed(400, 2) == 300 );
+	REQUIRE( decayed(0x8000 | 400, 2) == (0x8000 | 300) );
+	REQUIRE( decayed(3, 2) == 0 );
+	REQUIRE( decayed(0x8000 | 3, 2) == 0 );
+	REQUIRE( decayed(0x7FFF, 1) == 0x4000 );
+}
+
+} /* namespace local_tests */
+} /* namespace supreme */
@@ -0,0 +1,64 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/slotqueue.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "slot queue keeps order and drops when full", "[slotqueue]" )
+{
+	SlotQueue<16, 4> q;
+	REQUIRE( q.empty() );
+	REQUIRE( q.size() == 0 );
+
+	uint8_t data[16];
+	for (uint8_t i = 0; i < 16; ++i) data[i] = i;
+
+	/* 3 usable slots */
+	for (uint8_t n = 1; n <= 3; ++n) {
+		data[0] = n;
+		REQUIRE( q.push(data, n + 4) );
+	}
+	REQUIRE( q.full() );
+	REQUIRE( q.size() == 3 );
+	REQUIRE_FALSE( q.push(data, 1) );
+
+	for (uint8_t n = 1; n <= 3; ++n) {
+		REQUIRE_FALSE( q.empty() );
+		REQUIRE( q.front()[0] == n );
+		REQUIRE( q.front()[1] == 1 );
+		REQUIRE( q.front_length() == n + 4 );
+		q.pop();
+	}
+	REQUIRE( q.empty() );
+	q.pop(); /* no effect on empty queue */
+	REQUIRE( q.empty() );
+
+	/* too long */
+	REQUIRE_FALSE( q.push(data, 17) );
+	REQUIRE( q.push(data, 16) );
+}
+
+TEST_CASE( "slot queue wraps around", "[slotqueue]" )
+{
+	SlotQueue<8, 8> q;
+	uint8_t data[8] = {};
+	uint8_t pushed = 0, popped = 0;
+
+	/* fill level varies between 0 and 3 */
+	for (unsigned i = 0; i < 1000; ++i) {
+		const unsigned n = i % 4;
+		for (unsigned k = 0; k < n; ++k) {
+			data[0] = pushed++;
+			REQUIRE( q.push(data, 8) );
+		}
+		while (not q.empty()) {
+			REQUIRE( q.front()[0] == popped++ );
+			q.pop();
+		}
+	}
+	REQUIRE( pushed == popped );
+}
+
+} /* namespace local_tests */
+} /* namespace supreme */
@@ -0,0 +1,192 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/slottable.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+using namespace slottable;
+
+typedef Schedule<10, 20, 64> Schedule_t; /* 660us slots */
+
+TEST_CASE( "uniform slot table equals former fixed timing", "[slottable]")
+{
+	const Table t = make_uniform(100, 80, 8, 64);
+	REQUIRE( Schedule_t::is_valid(t) );
+	REQUIRE( Schedule_t::comm_us(t) == 8*660 + 20 );
+
+	for (uint8_t id = 0; id < 8; ++id) {
+		Schedule_t s;
+		REQUIRE( s.load(t, id) );
+		REQUIRE( s.has_own_slot() );
+		REQUIRE( s.get_frametime_us()   == 10000 );
+		REQUIRE( s.get_motortime_us()   ==  8000 );
+		REQUIRE( s.get_local_delay_us() == id * 660u + 20 );
+		for (uint8_t ref = 0; ref < 8; ++ref)
+			REQUIRE( s.get_sync_us(ref) == 10000 - ref * 660u );
+	}
+}
+
+TEST_CASE( "slot order and length determine the timing", "[slottable]")
+{
+	typedef Schedule<4, 20, 64> Fast_t; /* 276us slots, 3 Mbaud */
+
+	/* small limb at 500Hz: trunk, two boards, the latter with a longer slot */
+	const Table t = { 0, 20, 16, 3, { slot_entry(4, 64), slot_entry(1, 64), slot_entry(0, 80), 0, 0, 0, 0, 0 } };
+	REQUIRE( Fast_t::is_valid(t) );
+	REQUIRE_FALSE( Schedule_t::is_valid(t) ); /* slots exceed motor phase */
+
+	Fast_t s;
+	REQUIRE( s.load(t, 0) );
+	REQUIRE( s.get_frametime_us()   == 2000 );
+	REQUIRE( s.get_motortime_us()   == 1600 );
+	REQUIRE( s.get_local_delay_us() == 2*276 + 20 );
+	REQUIRE( s.get_sync_us(4) == 2000 );
+	REQUIRE( s.get_sync_us(1) == 2000 - 276 );
+	REQUIRE( s.get_sync_us(0) == 2000 - 2*276 );
+	REQUIRE( s.get_slot_start_us(1) == 276 + 20 );
+	REQUIRE( s.get_slot_end_us(1) == 2*276 );
+	REQUIRE( s.get_slot_end_us(0) == 2*276 + 80*4 + 20 );
+	REQUIRE( s.get_slot_end_us(2) == 0 ); /* no slot */
+
+	REQUIRE( s.load(t, 2) );
+	REQUIRE_FALSE( s.has_own_slot() );
+}
+
+TEST_CASE( "slot lengths fitted to topology", "[slottable]")
+{
+	typedef Schedule<10, 20, 24> Fitted_t;
+	const Table t = make_fitted(100, 80, topology::quadruped);
+	REQUIRE( Fitted_t::is_valid(t) );
+	REQUIRE( fits(t, topology::quadruped) );
+	REQUIRE( t.num_slots == 8 );
+	for (uint8_t b = 0; b < 4; ++b)
+		REQUIRE( bytes_of(t.slots[b]) == 112 ); /* 3 motors */
+	for (uint8_t b = 4; b < 8; ++b)
+		REQUIRE( bytes_of(t.slots[b]) == 24 ); /* none */
+	REQUIRE( Fitted_t::comm_us(t) == 4*1140 + 4*260 + 20 );
+
+	REQUIRE_FALSE( fits(make_uniform(100, 80, 8, 104), topology::quadruped) );
+	REQUIRE( fits(make_uniform(100, 80, 8, 112), topology::quadruped) );
+}
+
+TEST_CASE( "invalid slot tables are rejected", "[slottable]")
+{
+	Table t = make_uniform(100, 80, 8, 64);
+	Schedule_t s;
+
+	SECTION( "no slots" ) {
+		t.num_slots = 0;
+		REQUIRE_FALSE( s.load(t, 0) );
+	}
+	SECTION( "duplicate board" ) {
+		t.slots[3] = slot_entry(2, 64);
+		REQUIRE_FALSE( s.load(t, 0) );
+	}
+	SECTION( "slot too short" ) {
+		t.slots[3] = slot_entry(3, 56);
+		REQUIRE_FALSE( s.load(t, 0) );
+	}
+	SECTION( "motor phase overlaps slots" ) {
+		t.motor_100us = 50;
+		REQUIRE_FALSE( s.load(t, 0) );
+	}
+	SECTION( "motor phase after end of frame" ) {
+		t.frame_100us = 80;
+		REQUIRE_FALSE( s.load(t, 0) );
+	}
+}
+
+template <typename S>
+void transfer(S const& from, S& to, uint8_t first_frame, unsigned frames)
+{
+	std::array<uint8_t, 64> slot;
+	slot.fill(0xEE);
+	for (unsigned f = 0; f < frames; ++f) {
+		const Chunk c = from.get_chunk(first_frame + f);
+		for (unsigned i = 0; i < chunk_bytes; ++i)
+			slot[slot.size() - 1 - chunk_bytes + i] = c[i];
+		to.receive_slot(slot, slot.size());
+	}
+}
+
+TEST_CASE( "slot table is distributed by the leading board", "[slottable]")
+{
+	Schedule_t leader, follower;
+	REQUIRE( leader.load(make_uniform(50, 40, 5, 64), 0) );
+	REQUIRE( follower.load(make_uniform(100, 80, 8, 64), 3) );
+
+	/* incomplete */
+	transfer(leader, follower, 7, num_chunks - 1);
+	REQUIRE_FALSE( follower.update(3) );
+	REQUIRE( follower.get_frametime_us() == 10000 );
+
+	/* complete, starting at arbitrary frame */
+	transfer(leader, follower, 7 + num_chunks - 1, 1);
+	REQUIRE( follower.update(3) );
+	REQUIRE( follower.get_table() == leader.get_table() );
+	REQUIRE( follower.get_frametime_us()   == 5000 );
+	REQUIRE( follower.get_local_delay_us() == 3*660 + 20 );
+
+	/* applied only once */
+	REQUIRE_FALSE( follower.update(3) );
+	transfer(leader, follower, 0, 2*num_chunks);
+	REQUIRE_FALSE( follower.update(3) );
+}
+
+TEST_CASE( "distributed slot table must fit the topology", "[slottable]")
+{
+	Schedule_t leader, follower;
+	REQUIRE( follower.load(make_uniform(100, 80, 8, 64), 3) );
+	follower.set_topology(topology::quadruped, false);
+
+	/* stale table of the leader, slots too short for 3 motors */
+	REQUIRE( leader.load(make_uniform(90, 70, 8, 64), 0) );
+	transfer(leader, follower, 0, num_chunks);
+	REQUIRE_FALSE( follower.update(3) );
+	REQUIRE( follower.get_frametime_us() == 10000 );
+
+	REQUIRE( leader.load(make_uniform(95, 93, 8, 112), 0) );
+	transfer(leader, follower, 0, num_chunks);
+	REQUIRE( follower.update(3) );
+	REQUIRE( follower.get_frametime_us() == 9500 );
+}
+
+TEST_CASE( "mixed up slot table chunks are discarded", "[slottable]")
+{
+	Schedule_t a, b, follower;
+	REQUIRE( a.load(make_uniform(50, 40, 5, 64), 0) );
+	REQUIRE( b.load(make_uniform(60, 50, 6, 64), 0) );
+	REQUIRE( follower.load(make_uniform(100, 80, 8, 64), 1) );
+
+	/* leader changes its table during transfer */
+	transfer(a, follower, 0, 3);
+	transfer(b, follower, 3, 3);
+	REQUIRE_FALSE( follower.update(1) );
+
+	transfer(b, follower, 0, 3);
+	REQUIRE( follower.update(1) );
+	REQUIRE( follower.get_table() == b.get_table() );
+}
+
+TEST_CASE( "slot table chunk is read from end of variable length slot", "[slottable]")
+{
+	Schedule_t leader, follower;
+	REQUIRE( leader.load(make_uniform(50, 40, 5, 64), 0) );
+	REQUIRE( follower.load(make_uniform(100, 80, 8, 64), 1) );
+
+	std::array<uint8_t, 72> slot;
+	const unsigned length = 17; /* board without motors */
+	for (uint8_t f = 0; f < num_chunks; ++f) {
+		slot.fill(0xEE);
+		const Chunk c = leader.get_chunk(f);
+		for (unsigned i = 0; i < chunk_bytes; ++i)
+			slot[length - 1 - chunk_bytes + i] = c[i];
+		follower.receive_slot(slot, length);
+		follower.receive_slot(slot, slot.size() + 1); /* ignored */
+	}
+	REQUIRE( follower.update(1) );
+	REQUIRE( follower.get_table() == leader.get_table() );
+}
+
+}} // namespace supreme::local_tests
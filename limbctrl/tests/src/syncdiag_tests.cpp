@@ -0,0 +1,75 @@
+#include <cstdint>
+#include <cstdlib>
+#include "./catch_1.10.0.hpp"
+#include <src/syncdiag.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+using namespace syncdiag;
+
+TEST_CASE( "jitter histogram bins", "[syncdiag]" )
+{
+	REQUIRE( bin(0) == 0 );
+	REQUIRE( bin(124) == 0 );
+	REQUIRE( bin(125) == 1 );
+	REQUIRE( bin(-125) == 1 );
+	REQUIRE( bin(499) == 2 );
+	REQUIRE( bin(500) == 3 );
+	REQUIRE( bin(7999) == 6 );
+	REQUIRE( bin(8000) == 7 );
+	REQUIRE( bin(1000000) == 7 );
+}
+
+TEST_CASE( "sync diagnostics are published on frame counter wrap", "[syncdiag]" )
+{
+	SyncDiagnostics d;
+	REQUIRE( d.get_record().min > d.get_record().max ); /* no measurements */
+
+	std::srand(1234);
+	unsigned frame = 1;
+	for (unsigned n = 0; n < 3 * 256; ++n, ++frame) {
+		d.next_frame(frame & 0xff);
+		/* drift of 500 ns per frame, jitter up to +-100 ns */
+		const int32_t jitter = std::rand() % 201 - 100;
+		d.measure(-700 + (int32_t) (n % 10), 500 + jitter, n > 0);
+	}
+
+	Record const& r = d.get_record();
+	REQUIRE( r.min == -700 );
+	REQUIRE( r.max == -691 );
+	REQUIRE( r.drift >= 480 );
+	REQUIRE( r.drift <= 520 );
+
+	unsigned count = 0;
+	for (auto h: r.histogram) count += h;
+	REQUIRE( count == 255 ); /* saturated */
+	REQUIRE( r.histogram[0] == 255 );
+	REQUIRE( r.histogram[7] == 0 );
+
+	/* serialized one byte per frame */
+	REQUIRE( d.get_byte( 2) == ((uint16_t) -700 >> 8) );
+	REQUIRE( d.get_byte( 3) == ((uint16_t) -700 & 0xff) );
+	REQUIRE( (int16_t) (d.get_byte(22) << 8 | d.get_byte(23)) == r.drift );
+	REQUIRE( d.get_byte(8) == 255 );
+	REQUIRE( d.get_byte(15) == 0 );
+}
+
+TEST_CASE( "non-consecutive frames only count offsets", "[syncdiag]" )
+{
+	SyncDiagnostics d;
+	d.measure(100000, 40000, false);
+	d.measure(-5, 40000, false);
+	d.next_frame(0);
+
+	Record const& r = d.get_record();
+	REQUIRE( r.offset == -5 );
+	REQUIRE( r.min == -5 );
+	REQUIRE( r.max == 32767 ); /* saturated */
+	REQUIRE( r.drift == 0 );
+	for (auto h: r.histogram)
+		REQUIRE( h == 0 );
+}
+
+} /* namespace local_tests */
+} /* namespace supreme */
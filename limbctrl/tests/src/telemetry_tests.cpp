@@ -0,0 +1,243 @@
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "./catch_1.10.0.hpp"
+#include <src/telemetry.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+using namespace telemetry;
+
+struct VectorSink {
+	std::vector<uint8_t> data;
+	void add_byte(uint8_t b)  { data.push_back(b); }
+	void add_word(uint16_t w) { add_byte(w >> 8); add_byte(w & 0xff); }
+};
+
+typedef std::array<uint8_t, 112> Slot;
+
+/* builds a compact slot of a board as the spinal cord would */
+template <typename Encoder_t>
+unsigned make_slot(Encoder_t& enc, Slot& slot, uint8_t board, uint8_t frame, std::vector<Sample> const& samples)
+{
+	VectorSink s;
+	s.add_byte(0x55); s.add_byte(0x55);
+	s.add_byte(board);
+	s.add_byte(compact_slot_bytes(samples.size(), frame));
+	for (uint8_t i = 0; i < 5; ++i) s.add_byte(0);
+	s.add_byte(frame);
+	s.add_byte(0);
+	s.add_byte(samples.size() | compact_flag);
+	for (uint8_t i = 0; i < samples.size(); ++i)
+		enc.encode(s, frame, i, 10 + i, 4, samples[i]);
+	for (uint8_t i = 0; i < 4; ++i) s.add_byte(0xA0 + i); /* slot table */
+	uint8_t sum = 0;
+	for (auto b: s.data) sum += b;
+	s.add_byte(~sum + 1);
+
+	REQUIRE( s.data.size() == compact_slot_bytes(samples.size(), frame) );
+	slot.fill(0);
+	std::copy(s.data.begin(), s.data.end(), slot.begin());
+	return s.data.size();
+}
+
+Sample sample_at(Slot const& slot, uint8_t motor) {
+	Sample s;
+	const unsigned pos = header_bytes + motor * full_record + 2;
+	for (uint8_t i = 0; i < num_values; ++i)
+		s[i] = slot[pos + 2*i] << 8 | slot[pos + 2*i + 1];
+	return s;
+}
+
+TEST_CASE( "compact slot sizes", "[telemetry]")
+{
+	REQUIRE( full_record  == 30 );
+	REQUIRE( delta_record == 16 );
+	REQUIRE( compact_slot_bytes(0) == 17 );
+	REQUIRE( compact_slot_bytes(3) == 79 ); /* full: 107 */
+	REQUIRE( compact_slot_bytes(4) == 95 ); /* full: 137 */
+
+	for (uint8_t f = 0; f < 16; ++f)
+		REQUIRE( compact_slot_bytes(3, f) == ((f % 8 < 3) ? 79u : 65u) );
+
+	/* one key record per frame */
+	for (uint8_t f = 0; f < 16; ++f) {
+		unsigned keys = 0;
+		for (uint8_t m = 0; m < 4; ++m) keys += is_key(f, m);
+		REQUIRE( keys == ((f % 8 < 4) ? 1u : 0u) );
+	}
+}
+
+TEST_CASE( "compact telemetry round trip", "[telemetry]")
+{
+	Encoder<4> enc;
+	Decoder<8, 4> dec;
+	Slot slot, out;
+
+	std::vector<Sample> samples(3);
+	for (auto& s: samples) s = {{ 512 << 6, 100, 0, 1200, 300, 0, 0, 0, 0, 0, 512 << 6, 0, 0, 0 }};
+
+	srand(1);
+	for (unsigned f = 0; f < 200; ++f) {
+		const uint8_t frame = f;
+		for (auto& s: samples)
+			for (uint8_t i = 0; i < num_values; ++i)
+				s[i] += is_slow(i) ? (rand() % 3 - 1) : (rand() % 101 - 50) << quant_shift[i]; /* within delta range */
+
+		const unsigned len = make_slot(enc, slot, 2, frame, samples);
+		const unsigned expanded = expand(dec, slot, len, out);
+		REQUIRE( expanded == 12 + 3 * full_record + 5 );
+		REQUIRE( out[3] == expanded );
+
+		uint8_t sum = 0;
+		for (unsigned i = 0; i < expanded; ++i) sum += out[i];
+		REQUIRE( sum == 0 );
+		REQUIRE( (out[11] & compact_flag) == 0 );
+		REQUIRE( out[expanded-5] == 0xA0 ); /* slot table kept */
+
+		for (uint8_t m = 0; m < 3; ++m) {
+			const unsigned pos = header_bytes + m * full_record;
+			REQUIRE( out[pos] == 10 + m );
+			if (f >= key_interval) { /* every motor had its key record */
+				REQUIRE( out[pos+1] == 4 );
+				const Sample s = sample_at(out, m);
+				for (uint8_t i = 0; i < num_values; ++i) {
+					if (is_slow(i) and not is_key(frame, m)) /* slow values alternate */
+						REQUIRE( std::abs((int) s[i] - (int) samples[m][i]) <= 2 );
+					else
+						REQUIRE( s[i] == samples[m][i] );
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE( "saturated deltas catch up", "[telemetry]")
+{
+	/* position, current, ext. sensor, back-EMF, calibrated position:
+	   a step of 500 steps is followed by 127 steps per frame */
+	for (uint8_t i: {0, 1, 5, 6, 7, 11, 13}) {
+		Encoder<4> enc;
+		Decoder<8, 4> dec;
+		Slot slot, out;
+
+		std::vector<Sample> samples(1);
+		samples[0] = {{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }};
+		samples[0][i] = 200 << quant_shift[i];
+		make_slot(enc, slot, 0, 0, samples); /* key */
+		REQUIRE( expand(dec, slot, slot[3], out) > 0 );
+
+		samples[0][i] = 700 << quant_shift[i];
+		uint16_t last = 200 << quant_shift[i];
+		for (uint8_t f = 1; f < 5; ++f) {
+			expand(dec, slot, make_slot(enc, slot, 0, f, samples), out);
+			const uint16_t value = sample_at(out, 0)[i];
+			REQUIRE( value == ((f < 4) ? last + (127 << quant_shift[i]) : 700 << quant_shift[i]) );
+			last = value;
+		}
+	}
+}
+
+TEST_CASE( "quantised deltas track motion between key frames", "[telemetry]")
+{
+	Encoder<4> enc;
+	Decoder<8, 4> dec;
+	Slot slot, out;
+
+	/* position ramps of several ADC counts per frame back and forth,
+	   velocity and current follow with noise */
+	for (int speed: {3, 7, 40, -25}) {
+		std::vector<Sample> samples(2);
+		samples[0] = {{ 300 << 6, 200, 0, 1200, 300, 0, 0, 0, 0, 0, 0, 0, 0, 0 }};
+		samples[1] = {{ 700 << 6, 200, 0, 1200, 300, 0, 0, 0, 0, 0, 0, 0, 0, 0 }};
+
+		srand(speed + 100);
+		for (unsigned f = 0; f < 100; ++f) {
+			for (auto& s: samples) {
+				s[0] += speed * 64;
+				s[1] = 200 + 4 * speed + rand() % 21 - 10;
+				s[2] = (uint16_t) (speed * 16 * 1000 / 5 + rand() % 401 - 200); /* 5ms frames */
+			}
+			const unsigned len = make_slot(enc, slot, 3, f, samples);
+			REQUIRE( expand(dec, slot, len, out) > 0 );
+
+			if (f < key_interval) continue;
+			for (uint8_t m = 0; m < 2; ++m) {
+				const Sample s = sample_at(out, m);
+				REQUIRE( s[0] == samples[m][0] );                                 /* exact, low 6 bits are zero */
+				REQUIRE( std::abs((int16_t) (s[1] - samples[m][1])) <= 2 );     /* half a step */
+				REQUIRE( std::abs((int16_t) (s[2] - samples[m][2])) <= 8 );     /* half a step */
+			}
+		}
+	}
+}
+
+TEST_CASE( "multi-turn position is tracked across turns", "[telemetry]")
+{
+	Encoder<4> enc;
+	Decoder<8, 4> dec;
+	Slot slot, out;
+
+	std::vector<Sample> samples(1);
+	samples[0] = {{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }};
+
+	int32_t multiturn = -3L * 65536 + (1000 << 6); /* turn -3, near the wrap */
+	for (unsigned f = 0; f < 40; ++f) {
+		multiturn += 60 << 6; /* 60 counts per frame, lower word wraps every ~17 frames */
+		samples[0][ 9] = (uint16_t) (multiturn >> 16);
+		samples[0][10] = (uint16_t) multiturn;
+		const unsigned len = make_slot(enc, slot, 1, f, samples);
+		REQUIRE( expand(dec, slot, len, out) > 0 );
+
+		const Sample s = sample_at(out, 0);
+		REQUIRE( (int32_t) ((uint32_t) s[9] << 16 | s[10]) == multiturn ); /* both words in the same frame */
+	}
+}
+
+TEST_CASE( "lost slot invalidates motors until key record", "[telemetry]")
+{
+	Encoder<4> enc;
+	Decoder<8, 4> dec;
+	Slot slot, out;
+
+	std::vector<Sample> samples(2);
+	samples[0] = {{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 }};
+	samples[1] = {{ 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 }};
+
+	for (uint8_t f = 0; f < 8; ++f)
+		expand(dec, slot, make_slot(enc, slot, 5, f, samples), out);
+	REQUIRE( out[header_bytes + 1] == 4 );
+	REQUIRE( out[header_bytes + full_record + 1] == 4 );
+
+	make_slot(enc, slot, 5, 8, samples); /* lost */
+
+	for (uint8_t f = 9; f < 17; ++f) {
+		samples[0][0] += 5 << 6;
+		samples[1][0] += 5 << 6;
+		expand(dec, slot, make_slot(enc, slot, 5, f, samples), out);
+		/* motor 1 has key in frame 9, motor 0 in frame 16 */
+		REQUIRE( out[header_bytes + 1]               == ((f >= 16) ? 4 : 0) );
+		REQUIRE( out[header_bytes + full_record + 1] == ((f >=  9) ? 4 : 0) );
+	}
+	REQUIRE( sample_at(out, 0)[0] == samples[0][0] );
+	REQUIRE( sample_at(out, 1)[0] == samples[1][0] );
+}
+
+TEST_CASE( "malformed compact slots are rejected", "[telemetry]")
+{
+	Encoder<4> enc;
+	Decoder<8, 4> dec;
+	Slot slot, out;
+	std::vector<Sample> samples(2);
+
+	const unsigned len = make_slot(enc, slot, 1, 0, samples);
+	REQUIRE( expand(dec, slot, len, out) > 0 );
+	REQUIRE( expand(dec, slot, len - 1, out) == 0 );
+	REQUIRE( expand(dec, slot, 16, out) == 0 );
+
+	slot[11] = 5 | compact_flag; /* too many motors */
+	REQUIRE( expand(dec, slot, len, out) == 0 );
+}
+
+}} // namespace supreme::local_tests
@@ -0,0 +1,63 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/topology.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+using namespace topology;
+
+TEST_CASE( "compiled topologies are valid", "[topology]")
+{
+	REQUIRE( is_valid(quadruped) );
+	REQUIRE( is_valid(hexapod) );
+
+	REQUIRE( max_motors(quadruped) == 3 );
+	REQUIRE( max_motors(hexapod)   == 4 );
+
+	REQUIRE( slot_bytes(0) == 17 );
+	REQUIRE( slot_size(quadruped) == 112 ); /* 12 +  90 + 4 + 1 = 107 */
+	REQUIRE( slot_size(hexapod)   == 144 ); /* 12 + 120 + 4 + 1 = 137 */
+
+	REQUIRE( transparent_bytes(quadruped.num_voltages) == 28 );
+	REQUIRE( transparent_bytes(hexapod.num_voltages)   == 48 );
+
+	/* legacy motor ids: board_id/2*6 + board_id%2 + 2*j */
+	for (uint8_t b = 0; b < 4; ++b)
+		for (uint8_t j = 0; j < 3; ++j)
+			REQUIRE( quadruped.boards[b].motor_ids[j] == b/2*6 + b%2 + 2*j );
+}
+
+TEST_CASE( "invalid topologies are detected", "[topology]")
+{
+	Table t = quadruped;
+	REQUIRE( is_valid(t) );
+
+	SECTION( "duplicate motor id" ) {
+		t.boards[1].motor_ids[2] = 4;
+		REQUIRE_FALSE( is_valid(t) );
+	}
+	SECTION( "motor id exceeds number of voltages" ) {
+		t.boards[3].motor_ids[2] = 12;
+		REQUIRE_FALSE( is_valid(t) );
+	}
+	SECTION( "too many motors per board" ) {
+		t.boards[0].num_motors = max_motors_per_board + 1;
+		REQUIRE_FALSE( is_valid(t) );
+	}
+	SECTION( "number of boards" ) {
+		t.num_boards = 0;
+		REQUIRE_FALSE( is_valid(t) );
+		t.num_boards = max_boards + 1;
+		REQUIRE_FALSE( is_valid(t) );
+	}
+	SECTION( "exceeding slot or voltage capacity" ) {
+		t.boards[4] = { 4, {12, 13, 14, 15} };
+		t.num_voltages = 16;
+		REQUIRE( is_valid(t) );
+		REQUIRE_FALSE( is_valid(t, slot_size(quadruped), 16) );
+		REQUIRE_FALSE( is_valid(t, slot_size(t), 12) );
+	}
+}
+
+}} // namespace supreme::local_tests
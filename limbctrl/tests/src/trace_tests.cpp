@@ -0,0 +1,90 @@
+#include <cstdint>
+#include "./catch_1.10.0.hpp"
+#include <src/trace.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "trace ring keeps the latest entries, oldest first", "[trace]" )
+{
+	trace::Ring<8> ring;
+	REQUIRE( ring.size() == 0 );
+
+	ring.set_frame(7);
+	ring.add(trace::slot, 1000, 3, 71);
+	REQUIRE( ring.size() == 1 );
+	REQUIRE( ring.get(0).time  == 1000 );
+	REQUIRE( ring.get(0).kind  == trace::slot );
+	REQUIRE( ring.get(0).frame == 7 );
+	REQUIRE( ring.get(0).arg   == 3 );
+	REQUIRE( ring.get(0).data  == 71 );
+
+	for (uint32_t t = 1; t <= 10; ++t)
+		ring.add(trace::state, 1000 + t, t);
+	REQUIRE( ring.size() == 8 );
+	for (unsigned i = 0; i < 8; ++i)
+		REQUIRE( ring.get(i).arg == i + 3 );
+
+	/* frozen, new entries are dropped */
+	ring.freeze();
+	ring.add(trace::rx_timeout, 2000);
+	REQUIRE( ring.get(7).arg == 10 );
+	ring.unfreeze();
+	ring.add(trace::rx_timeout, 2000);
+	REQUIRE( ring.get(7).kind == trace::rx_timeout );
+	REQUIRE( ring.get(0).arg == 4 );
+}
+
+TEST_CASE( "trace is dumped in chunks", "[trace]" )
+{
+	typedef trace::Ring<64> Ring_t;
+	Ring_t ring;
+	trace::Dump<Ring_t> dump(ring);
+	std::array<uint8_t, trace::chunk_bytes> buffer;
+	REQUIRE( Ring_t::num_chunks == 2 );
+
+	for (uint32_t t = 0; t < 40; ++t)
+		ring.add(trace::state, 0x01020300 + t, t, 0xAA);
+
+	REQUIRE( dump.next<0x55>(3, buffer) == 0 ); /* not started */
+	dump.start();
+	REQUIRE( dump.is_active() );
+	REQUIRE( ring.is_frozen() );
+
+	unsigned length = dump.next<0x55>(3, buffer);
+	REQUIRE( length == trace::chunk_bytes );
+	REQUIRE( buffer[0] == 0x55 );
+	REQUIRE( buffer[1] == 0x55 );
+	REQUIRE( buffer[2] == trace::dump_id );
+	REQUIRE( buffer[3] == 3 );
+	REQUIRE( buffer[4] == 0 );
+	REQUIRE( buffer[5] == 2 );
+	REQUIRE( buffer[6] == 32 );
+	/* first entry */
+	REQUIRE( buffer[7]  == 0x01 );
+	REQUIRE( buffer[8]  == 0x02 );
+	REQUIRE( buffer[9]  == 0x03 );
+	REQUIRE( buffer[10] == 0x00 );
+	REQUIRE( buffer[11] == trace::state );
+	REQUIRE( buffer[13] == 0 );
+	REQUIRE( buffer[14] == 0xAA );
+	uint8_t sum = 0;
+	for (unsigned i = 0; i < length; ++i) sum += buffer[i];
+	REQUIRE( sum == 0 );
+
+	REQUIRE( dump.is_active() );
+	length = dump.next<0x55>(3, buffer);
+	REQUIRE( length == trace::header_bytes + 8 * trace::entry_bytes + 1 );
+	REQUIRE( buffer[4] == 1 );
+	REQUIRE( buffer[6] == 8 );
+	REQUIRE( buffer[7 + 2] == 0x03 );
+	REQUIRE( buffer[7 + 3] == 32 );
+	sum = 0;
+	for (unsigned i = 0; i < length; ++i) sum += buffer[i];
+	REQUIRE( sum == 0 );
+
+	REQUIRE_FALSE( dump.is_active() );
+	REQUIRE_FALSE( ring.is_frozen() );
+}
+
+}} // namespace supreme::local_tests
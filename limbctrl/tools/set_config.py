@@ -0,0 +1,130 @@
+#!/usr/bin/python
+
+# Writes the board configuration (board id, trunk role, topology, slot
+# table, supply derating, full scale of the voltage inputs and ext. sensor
+# prefetch) of a limb controller via its external rs485 port.
+# The board stores the config in flash, acknowledges and restarts.
+# A trunk controller accepts a config only within 500ms after reset.
+
+import serial
+import argparse
+
+
+default_port = '/dev/ttyUSB0'
+baudrate = 3000000
+timeout_s = 3.0 # erasing the flash sector may take up to 2s
+sync = [0x55, 0x55]
+config_id = 0xFE
+
+max_boards = 8
+max_motors_per_board = 4
+
+# motor ids per board, as in firmware/src/topology.hpp
+topologies = {
+	'quadruped': (12, [[0,2,4], [1,3,5], [6,8,10], [7,9,11], [], [], [], []]),
+	'hexapod'  : (22, [[0,1,2,3], [4,5,6,7], [8,9,10], [11,12,13], [], [14,15,16,17], [18,19,20,21], []]),
+}
+
+
+def encode_topology(name):
+	num_voltages, boards = topologies[name]
+	data = [len(boards), num_voltages]
+	for ids in boards:
+		data += [len(ids)] + ids + [0]*(max_motors_per_board - len(ids))
+	return data
+
+
+# slot length as in topology::slot_bytes() or telemetry::compact_slot_bytes(),
+# rounded up to multiples of 8
+def fitted_slot_bytes(num_motors, compact):
+	if compact and num_motors > 0:
+		n = 12 + 16*(num_motors - 1) + 30 + 4 + 1
+	else:
+		n = 12 + 30*num_motors + 4 + 1
+	return (n + 7) // 8 * 8
+
+
+def encode_slot_table(frame_us, motor_us, order, slot_bytes, topology, compact):
+	assert(len(order) <= max_boards)
+	boards = topologies[topology][1]
+	data = [0, frame_us // 100, motor_us // 100, len(order)]
+	for b in order:
+		length = slot_bytes or fitted_slot_bytes(len(boards[b]), compact)
+		data.append(((length // 8) << 3) | (b & 0x7))
+	return data + [0]*(max_boards - len(order))
+
+
+# little endian, as the config struct in the board's memory
+def encode_word(value):
+	assert(0 <= value <= 0xffff)
+	return [value & 0xff, value >> 8]
+
+
+# supply thresholds as in firmware/src/health.hpp
+def encode_derating(full_mV, min_mV, absent_mV):
+	assert(absent_mV < min_mV < full_mV)
+	return encode_word(full_mV) + encode_word(min_mV) + encode_word(absent_mV)
+
+
+def frame(payload):
+	sendbuf = sync + [config_id] + payload
+	checksum = (~sum(sendbuf) + 1) % 256
+	return bytearray(sendbuf + [checksum])
+
+
+def main():
+	parser = argparse.ArgumentParser()
+	parser.add_argument('-p', '--port'      , default=default_port)
+	parser.add_argument('-b', '--board'     , type=int, required=True)
+	parser.add_argument('-t', '--trunk'     , action='store_true')
+	parser.add_argument('-c', '--compact'   , action='store_true') # compact telemetry, must be set for all boards
+	parser.add_argument('-l', '--local'     , action='store_true') # local controller computes the board's motor targets
+	parser.add_argument('-a', '--aggregate' , action='store_true') # trunk sends one robot state frame per cycle
+	parser.add_argument('-H', '--halt'      , action='store_true') # every fault halts the board, for debugging
+	parser.add_argument('-T', '--topology'  , default='quadruped', choices=sorted(topologies.keys()))
+	parser.add_argument('-f', '--frame_us'  , type=int, default=10000)
+	parser.add_argument('-m', '--motor_us'  , type=int, default=8000)
+	parser.add_argument('-o', '--order'     , default='0,1,2,3,4,5,6,7') # board ids in slot order
+	parser.add_argument('-s', '--slot_bytes', type=int, default=0) # 0: fitted to the board's motors
+	parser.add_argument('--full_mV'         , type=int, default=10500) # pwm limit is derated below
+	parser.add_argument('--min_mV'          , type=int, default=9600)  # lowest pwm limit (1/4) at and below
+	parser.add_argument('--absent_mV'       , type=int, default=5000)  # supply not measured below, no derating
+	parser.add_argument('--full_scale_mV'   , type=int, default=36300) # voltage inputs, calibrate against a meter
+	parser.add_argument('--ext_divider'     , type=int, default=10)    # ext. sensor prefetch every n-th motor tick, 0: off
+	args = parser.parse_args()
+
+	if not 0 <= args.board < max_boards:
+		print("Board id '{0}' is out of range 0..{1}".format(args.board, max_boards-1))
+		return
+
+	order = [int(b) for b in args.order.split(',')]
+	flags = (0x01 if args.trunk     else 0) \
+	      | (0x02 if args.compact   else 0) \
+	      | (0x04 if args.local     else 0) \
+	      | (0x08 if args.aggregate else 0) \
+	      | (0x10 if args.halt      else 0)
+	payload = [args.board, flags] \
+	        + encode_topology(args.topology) \
+	        + encode_slot_table(args.frame_us, args.motor_us, order, args.slot_bytes, args.topology, args.compact) \
+	        + encode_derating(args.full_mV, args.min_mV, args.absent_mV) \
+	        + encode_word(args.full_scale_mV) \
+	        + [args.ext_divider, 0, 0, 0]
+	assert(len(payload) == 68)
+	msg = frame(payload)
+
+	with serial.Serial(args.port, baudrate, timeout=timeout_s) as ser:
+		print("Connected to port {0}\nwith baudrate {1}.\n".format(ser.port, ser.baudrate))
+		ser.timeout = 0.1
+		while ser.read(): pass
+		ser.timeout = timeout_s
+		ser.write(msg)
+		resp = bytearray(ser.read(len(msg)))
+		if resp == msg:
+			print("Board {0} configured, restarting.".format(args.board))
+		else:
+			print("No or invalid response, config rejected.")
+
+	print("\n____\nDONE.")
+
+
+if __name__ == "__main__": main()
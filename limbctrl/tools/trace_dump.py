@@ -0,0 +1,159 @@
+#!/usr/bin/python
+
+# Requests the trace of the frame cycle from a limb controller via its
+# external rs485 port and renders it as timeline, one line per frame.
+# The trace holds the last 512 events: state transitions, slot receptions,
+# timer events and timeouts, see firmware/src/trace.hpp for the format.
+# On the trunk controller, the dump is interleaved with the forwarded slots.
+
+import serial
+import argparse
+import time
+
+
+default_port = '/dev/ttyUSB0'
+baudrate = 3000000
+timeout_s = 1.0
+dump_s = 2.0 # one chunk per frame, 16 chunks
+sync = [0x55, 0x55]
+dump_id = 0xFC
+
+header_bytes = 7
+entry_bytes = 8
+clock_hz = 96000000 # cycle counter
+
+# as in enum CycleState, firmware/main.cpp
+states = ['initializing', 'synchronizing', 'synchronized', 'receiving', 'transmitting',
+          'receiving_2', 'writing_motors', 'idle', 'duplicate_id']
+state_chars = 'IYSrTRWi!'
+
+kinds = { 1: 'state', 2: 'frame_start', 3: 'slot', 4: 'rx_timeout', 5: 'send_slot',
+          6: 'comm_end', 7: 'motor_phase', 8: 'failover', 9: 'holdover' }
+
+
+def request():
+	sendbuf = sync + [dump_id]
+	checksum = (~sum(sendbuf) + 1) % 256
+	return bytearray(sendbuf + [checksum])
+
+
+# returns the chunks found in the received bytes, other frames are skipped
+def parse_chunks(data):
+	chunks = {}
+	i = 0
+	while i + header_bytes < len(data):
+		if data[i] != sync[0] or data[i+1] != sync[1] or data[i+2] != dump_id:
+			i += 1
+			continue
+		n = data[i+6]
+		length = header_bytes + n*entry_bytes + 1
+		frame = data[i:i+length]
+		if len(frame) < length or sum(frame) % 256 != 0:
+			i += 1
+			continue
+		board, index, num_chunks = frame[3], frame[4], frame[5]
+		entries = []
+		for k in range(n):
+			e = frame[header_bytes + k*entry_bytes : header_bytes + (k+1)*entry_bytes]
+			t = (e[0] << 24) | (e[1] << 16) | (e[2] << 8) | e[3]
+			entries.append((t, e[4], e[5], e[6], e[7]))
+		chunks[index] = (board, num_chunks, entries)
+		i += length
+	return chunks
+
+
+def describe(kind, arg, data):
+	name = kinds.get(kind, 'unknown({0})'.format(kind))
+	if kind == 1:
+		return states[arg] if arg < len(states) else 'state({0})'.format(arg)
+	if kind == 3:
+		return 'slot {0} ({1} bytes)'.format(arg, data)
+	if kind == 8:
+		return 'failover to {0}'.format(arg)
+	if kind == 9:
+		return 'holdover ({0} missed)'.format(arg)
+	return name
+
+
+# splits the entries into frames at each frame start, times are unwrapped
+def split_frames(entries):
+	if not entries: return []
+	t0 = entries[0][0]
+	events = sorted(((t - t0) % 2**32, kind, frame, arg, data) for (t, kind, frame, arg, data) in entries)
+	frames = [[]]
+	for e in events:
+		if e[1] == 2 and frames[-1]:
+			frames.append([])
+		frames[-1].append(e)
+	return frames
+
+
+# one character per column, the state of the main loop at that time,
+# <current> is the state at the start of the frame
+def state_strip(frame, frame_us, width, current):
+	strip = [' '] * width
+	start = frame[0][0]
+	changes = [(e[0], e[3]) for e in frame if e[1] == 1]
+	for col in range(width):
+		t = start + col * frame_us * clock_hz / 1e6 / width
+		while changes and changes[0][0] <= t:
+			current = changes.pop(0)[1]
+		if current is not None and current < len(state_chars):
+			strip[col] = state_chars[current]
+	return ''.join(strip), current
+
+
+def render(frames, frame_us, width, verbose):
+	print("states: " + ', '.join('{0}={1}'.format(c, s) for c, s in zip(state_chars, states)) + '\n')
+	current = None
+	for f in frames:
+		start = f[0][0]
+		strip, current = state_strip(f, frame_us, width, current)
+		print('frame {0:3d} |{1}|'.format(f[-1][2], strip))
+		if not verbose: continue
+		for (t, kind, frame, arg, data) in f:
+			print('    {0:9.1f} us  {1}'.format((t - start) * 1e6 / clock_hz, describe(kind, arg, data)))
+
+
+def main():
+	parser = argparse.ArgumentParser()
+	parser.add_argument('-p', '--port'    , default=default_port)
+	parser.add_argument('-f', '--frame_us', type=int, default=10000) # width of the timeline
+	parser.add_argument('-w', '--width'   , type=int, default=100)
+	parser.add_argument('-v', '--verbose' , action='store_true') # list all events
+	args = parser.parse_args()
+
+	with serial.Serial(args.port, baudrate, timeout=timeout_s) as ser:
+		print("Connected to port {0}\nwith baudrate {1}.\n".format(ser.port, ser.baudrate))
+		ser.reset_input_buffer()
+		ser.write(request())
+
+		data = bytearray()
+		chunks = {}
+		deadline = time.time() + dump_s
+		while time.time() < deadline:
+			received = ser.read(4096)
+			if not received: break
+			data += received
+			chunks = parse_chunks(data)
+			if chunks and len(chunks) == list(chunks.values())[0][1]: break
+
+	if not chunks:
+		print("No response.")
+		return
+
+	board, num_chunks = list(chunks.values())[0][:2]
+	if len(chunks) < num_chunks:
+		print("Incomplete dump, {0} of {1} chunks.".format(len(chunks), num_chunks))
+
+	entries = []
+	for index in sorted(chunks.keys()):
+		entries += chunks[index][2]
+	print("Board {0}, {1} events.\n".format(board, len(entries)))
+
+	render(split_frames(entries), args.frame_us, args.width, args.verbose)
+
+	print("\n____\nDONE.")
+
+
+if __name__ == "__main__": main()
@@ -0,0 +1,75 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Sensorimotor Firmware           |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_CALIBRATION_HPP
+#define SUPREME_CALIBRATION_HPP
+
+namespace supreme {
+
+/* Piecewise-linear calibration table with up to N breakpoints,
+   mapping a 10 bit ADC reading to a signed 16 bit value in engineering
+   units (e.g. 0.01 degree). Breakpoints must be strictly ascending in x,
+   inputs beyond the first or last breakpoint are clipped. The slopes of
+   all segments are precomputed (Q8), hence no division is needed when
+   applying the table. A table of less than 2 breakpoints is invalid and
+   the identity (10 bit reading) is returned instead. */
+template <uint8_t N>
+class Calibration {
+public:
+	struct Point { uint16_t x; int16_t y; };
+
+private:
+	Point   points[N];
+	int32_t slope[N];   /* Q8, of segment i to i+1 */
+	uint8_t count = 0;  /* number of valid breakpoints */
+
+public:
+	static const uint8_t max_points = N;
+
+	Calibration() : points(), slope() {}
+
+	/* setting point i truncates the table to i+1 points,
+	   hence upload points in ascending order */
+	bool set_point(uint8_t i, uint16_t x, int16_t y) {
+		if (i >= N) return false;
+		points[i] = { x, y };
+		count = i + 1;
+		return update();
+	}
+
+	Point const& get_point(uint8_t i) const { return points[i]; }
+	uint8_t get_count(void) const { return count; }
+	bool is_valid(void) const { return count >= 2; }
+
+	void clear(void) { count = 0; }
+
+	/* recompute slopes, invalidate table if not ascending */
+	bool update(void) {
+		for (uint8_t i = 0; i + 1 < count; ++i) {
+			const int32_t dx = (int32_t) points[i+1].x - points[i].x;
+			if (dx <= 0) { count = 0; return false; }
+			slope[i] = ((int32_t) points[i+1].y - points[i].y) * 256 / dx;
+		}
+		return true;
+	}
+
+	int16_t apply(uint16_t x) const {
+		if (not is_valid()) return x;
+		if (x <= points[0].x) return points[0].y;
+
+		uint8_t i = 0;
+		while (i + 1 < count and x >= points[i+1].x) ++i;
+		if (i + 1 == count) return points[i].y;
+
+		return points[i].y + (int32_t) (x - points[i].x) * slope[i] / 256;
+	}
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_CALIBRATION_HPP */
@@ -0,0 +1,57 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Sensorimotor Firmware           |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_DIFFERENTIATOR_HPP
+#define SUPREME_DIFFERENTIATOR_HPP
+
+namespace supreme {
+
+/* Differentiation filter with noise reduction
+   optimized for integer arithmetics:
+   See Paper: "One-Sided Differentiators" by Pavel Holoborodko
+   http://www.holoborodko.com/pavel/ August 24, 2009
+
+   The filter (N=6) is stepped with a fixed sample rate, its taps are
+   D samples apart, hence the last 5*D+1 samples are kept in a ring buffer.
+   Samples are 16 bit fixed-point values, only differences of samples
+   are used, so samples may wrap around (e.g. multi-turn positions).
+   The result is 16 times the slope per D samples, i.e. the divisor of 16
+   of the filter is omitted (see paper). */
+template <uint8_t D>
+class Differentiator {
+	static const uint8_t N = 5*D + 1;
+	uint16_t x[N];
+	uint8_t  idx = 0;
+
+	uint16_t at(uint8_t k) const { /* k samples back in time */
+		return x[(idx >= k) ? idx - k : idx + N - k];
+	}
+
+	/* modular difference, valid across wrap-around */
+	int16_t diff(uint8_t k0, uint8_t k1) const { return (uint16_t) (at(k0) - at(k1)); }
+
+public:
+	Differentiator(uint16_t x0 = 0) { init(x0); }
+
+	void init(uint16_t x0) {
+		for (uint8_t i = 0; i < N; ++i)
+			x[i] = x0;
+	}
+
+	int32_t step(uint16_t x0) {
+		if (++idx == N) idx = 0;
+		x[idx] = x0;
+		return     (int32_t) diff(  0, 5*D)
+		     + 3 * (int32_t) diff(  D, 4*D)
+		     + 2 * (int32_t) diff(2*D, 3*D);
+	}
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_DIFFERENTIATOR_HPP */
@@ -0,0 +1,51 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Sensorimotor Firmware           |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_MULTITURN_HPP
+#define SUPREME_MULTITURN_HPP
+
+namespace supreme {
+
+/* Unwraps the 10 bit reading of a single-turn potentiometer and counts
+   the turns. Readings outside [gap_lo, gap_hi] are taken as being in the
+   potentiometer's gap (dead zone) and the last valid reading is held.
+   A jump of more than half a turn between two valid readings is taken
+   as a wrap-around. */
+class Multiturn {
+	const uint16_t gap_lo, gap_hi;
+	int16_t  turns = 0;
+	uint16_t last  = 0;
+public:
+	static const int16_t range = 1024; /* 10 bit per turn */
+
+	Multiturn(uint16_t gap_lo = 0, uint16_t gap_hi = range - 1)
+	: gap_lo(gap_lo), gap_hi(gap_hi) {}
+
+	void init(uint16_t raw) { last = raw; turns = 0; }
+
+	void step(uint16_t raw) {
+		if (raw < gap_lo or raw > gap_hi) return; /* within gap, hold last */
+		const int16_t delta = raw - last;
+		if      (delta >  range/2) --turns;
+		else if (delta < -range/2) ++turns;
+		last = raw;
+	}
+
+	/* unwrapped position in 10 bit units, continuous across turns */
+	int32_t get_counts(void) const { return (int32_t) turns * range + last; }
+
+	/* upper 16 bit: signed turn counter,
+	   lower 16 bit: position promoted to upper bits (as single-turn) */
+	int32_t get(void) const { return (int32_t) turns * 65536L + ((int32_t) last << 6); }
+
+	int16_t get_turns(void) const { return turns; }
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_MULTITURN_HPP */
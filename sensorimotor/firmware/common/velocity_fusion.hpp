@@ -0,0 +1,70 @@
+/*---------------------------------+
+ | Supreme Machines                |
+ | Sensorimotor Firmware           |
+ | Matthias Kubisch                |
+ | kubisch@informatik.hu-berlin.de |
+ | October 2026                    |
+ +---------------------------------*/
+
+#ifndef SUPREME_VELOCITY_FUSION_HPP
+#define SUPREME_VELOCITY_FUSION_HPP
+
+namespace supreme {
+
+/* Complementary filter, fusing the velocity derived from the position
+   (unbiased, but noisy at low speed) with the velocity derived from
+   the motor's back-EMF (low noise, but subject to errors of the motor
+   constants):
+
+       v = v_emf + lowpass(v_pos - v_emf)
+
+   with v_emf = (adc_emf - offset) * gain / 256 and a first-order lowpass
+   with coefficient 2^-shift. Hence the low frequencies are taken from
+   the position and the high frequencies from the back-EMF.
+   The back-EMF reading is expected to be centered around offset at
+   stand-still. As long as no gain is set (gain == 0) the fusion is
+   bypassed and v_pos is returned unchanged.
+
+   Cost per step, counted in an instruction level simulation of the
+   compiled step() (ATmega328P timings, LLVM's AVR backend, __mulsi3
+   taken as 40 cycles): 418 cycles with the default shift of 4, i.e.
+   26us at 16MHz or 2.6% of the 1kHz cycle, plus 36 cycles per further
+   shift step (both 32 bit shifts are loops), 61 cycles when bypassed.
+   avr-gcc shifts in fewer cycles, so this is an upper bound. */
+class VelocityFusion {
+	uint16_t offset = 512; /* adc reading at stand-still */
+	 int16_t gain   = 0;   /* Q8, velocity units per adc count */
+	uint8_t  shift  = 4;   /* lowpass coefficient 2^-shift */
+	 int32_t error  = 0;   /* lowpass of (v_pos - v_emf), Q(shift) */
+
+	static int16_t saturate(int32_t v) {
+		if (v >  32767) return  32767;
+		if (v < -32767) return -32767;
+		return v;
+	}
+
+public:
+	void set_constants(uint16_t offs, int16_t g, uint8_t s) {
+		offset = offs;
+		gain   = g;
+		shift  = (s < 16) ? s : 15;
+		error  = 0;
+	}
+
+	bool is_enabled(void) const { return gain != 0; }
+
+	int16_t get_emf_velocity(uint16_t adc_emf) const {
+		return saturate(((int32_t) adc_emf - offset) * gain / 256);
+	}
+
+	int16_t step(int16_t v_pos, uint16_t adc_emf) {
+		if (not is_enabled()) return v_pos;
+		const int16_t v_emf = get_emf_velocity(adc_emf);
+		error += (int32_t) v_pos - v_emf - (error >> shift);
+		return saturate(v_emf + (error >> shift));
+	}
+};
+
+} /* namespace supreme */
+
+#endif /* SUPREME_VELOCITY_FUSION_HPP */
@@ -21,6 +21,9 @@ namespace supreme {
  | This is a proxy class for selecting and loading an external sensor.  |
  | Currently only 1 sensor supported, namely the ADXL345, but is to be  |
  | extended for other sensors.                                          |
+ | The readout is either restarted on request (default) or prefetched,  |
+ | i.e. triggered by every n-th tick of the 1kHz main loop. In the      |
+ | latter case each sample is stamped with the tick it was started at.  |
  | TODO: Load sensor selection from EEPROM.                             |
  +----------------------------------------------------------------------*/
 
@@ -30,6 +33,8 @@ class ReaderThread : public xpcc::pt::Protothread, public xpcc::Resumable<1>
 	SensorType& s;
 	DataType& d;
 	bool next_readout = false;
+	uint16_t requested_at = 0; /* tick of the pending readout request */
+	uint16_t started_at = 0;   /* tick of the running readout */
 
 public:
 
@@ -41,13 +46,17 @@ public:
 		while (true)
 		{
 			PT_WAIT_UNTIL( next_readout == true );
+			next_readout = false; /* requests during readout are queued */
+			started_at = requested_at;
 			PT_CALL( step() ); /* read out the sensor */
-			next_readout = false;
 		}
 		PT_END();
 	}
 
-	void restart(void) { next_readout = true; }
+	void restart(uint16_t tick = 0) {
+		requested_at = tick;
+		next_readout = true;
+	}
 
 private:
 
@@ -68,6 +77,7 @@ private:
 		d.x = vacc[0];
 		d.y = vacc[1];
 		d.z = vacc[2];
+		d.timestamp = started_at;
 	}
 }; /* ReaderThread */
 
@@ -77,13 +87,16 @@ class ExternalSensor
 	uint8_t data[16];
 
 	typedef xpcc::Adxl345<I2cMaster> sensor_t;
-	typedef struct Values { int16_t x,y,z; } data_t;
+	typedef struct Values { int16_t x,y,z; uint16_t timestamp; } data_t;
 
 	sensor_t sensor;
 	data_t values;
 
 	ReaderThread<sensor_t, data_t> reader;
 
+	uint8_t divider = 0; /* 0: restart on request, n: prefetch every n-th tick */
+	uint8_t ticks = 0;
+
 public:
 
 	ExternalSensor()
@@ -96,8 +109,20 @@ public:
 
 	void step(void) { reader.update(); }
 
+	/* readout on request, not to be used when prefetching */
 	void restart(void) { reader.restart(); }
 
+	/* called once per cycle of the 1kHz main loop */
+	void tick(uint16_t cycles) {
+		if (not is_prefetching()) return;
+		if (++ticks < divider) return;
+		ticks = 0;
+		reader.restart(cycles);
+	}
+
+	void set_prefetch(uint8_t div) { divider = div; ticks = 0; }
+	bool is_prefetching(void) const { return divider > 0; }
+
 	Values const& get_values(void) const { return values; }
 
 }; /* ExternalSensor */
@@ -59,6 +59,8 @@ int main()
 			led::red::set();   // red led on, begin of cycle
 			core.step();
 			supreme::adc::restart();
+			exts.tick(cycles);
+			com.tick();
 			++cycles;
 			led::red::reset(); // red led off, end of cycle
 			previous_state = current_state;
@@ -50,6 +50,16 @@ public:
 		set_pwm_limit,   /* no response */
 		ext_sensor_request,
 		ext_sensor_request_resp,
+		ext_sensor_request_resp_ts,
+		set_ext_sensor_prefetch, /* no response */
+		set_position_mode,       /* no response */
+		set_motor_constants,     /* no response */
+		set_calibration_point,
+		set_calibration_point_response,
+		set_voltage_ext_sensor,
+		data_ext_sensor_response,
+		discover,              /* broadcast, delayed ping response */
+		set_pwm_limit_all,     /* broadcast, no response */
 	};
 
 	enum command_state_t {
@@ -69,7 +79,7 @@ private:
 	ExternalSensorType&          exts;
 	uint8_t                      recv_buffer = 0;
 	uint8_t                      recv_checksum = 0;
-	sendbuffer<16>               send;
+	sendbuffer<40>               send;
 
 	uint8_t                      motor_id = 127; // set to default
 	uint8_t                      target_id = 127;
@@ -79,6 +89,42 @@ private:
 	uint8_t                      target_pwm = 0;
 	uint8_t                      target_pwm_max = 0;
 
+	/* external sensor related */
+	uint8_t                      target_prefetch = 0;
+
+	/* sensor related */
+	uint8_t                      target_position_mode = 0;
+
+	/* bus discovery: motors with ids in [first, first + count)
+	   respond in consecutive time slots, ordered by id, counted in
+	   ticks of the 1kHz loop (see tick()). Processing the request and
+	   sending the response are each delayed by up to one cycle of the
+	   loop (< 1 ms), the tick boundaries of the motors are not aligned,
+	   hence a slot is 3 ticks and a motor responds after the first
+	   tick of its slot, within (0, 3) ms of the slot start. */
+	static const uint8_t         discovery_slot_ticks = 3;
+	static const uint8_t         max_discovery_count = 16; /* max. 48 ms */
+	uint8_t                      discovery_first = 0;
+	uint8_t                      discovery_count = 0;
+	bool                         discovery_pending = false;
+	uint16_t                     discovery_due = 0;
+	uint16_t                     ticks = 0;
+
+	/* calibration table: number of points at address 32,
+	   followed by 4 bytes per point (x hi, x lo, y hi, y lo).
+	   Points are applied right away and stored from step(), see
+	   store_calibration() */
+	static const uint16_t        eeprom_calib_addr = 32;
+	static const uint8_t         max_calib_points = 16; /* see defaults::calibration_points */
+	static const uint8_t         calib_bytes = 1 + 4*max_calib_points;
+	uint8_t                      calib_image[calib_bytes];
+	uint8_t                      calib_next = 0;
+	bool                         calib_dirty = false;
+
+	/* payload of commands with more than one data byte */
+	static const uint8_t         max_cmd_data = 5;
+	uint8_t                      cmd_data[max_cmd_data];
+
 	/* TODO struct? */
 	command_id_t                 cmd_id    = no_command;
 	command_state_t              cmd_state = syncing;
@@ -98,6 +144,7 @@ public:
 	, send()
 	{
 		read_id_from_EEPROM();
+		read_calibration_from_EEPROM();
 
 		rs485::drive_enable::setOutput();
 		rs485::drive_enable::reset();
@@ -119,6 +166,50 @@ public:
 		eeprom_write_byte((uint8_t*)23, (new_id | 0x80));
 	}
 
+	void read_calibration_from_EEPROM() {
+		eeprom_busy_wait();
+		for (uint8_t i = 0; i < calib_bytes; ++i)
+			calib_image[i] = eeprom_read_byte((uint8_t*)eeprom_calib_addr + i);
+
+		const uint8_t count = calib_image[0];
+		if (count == 0xFF) return; /* erased */
+		for (uint8_t i = 0; i < count and i < max_calib_points; ++i) {
+			uint8_t const* p = &calib_image[1 + 4*i];
+			if (not ux.set_calibration_point(i, p[0] << 8 | p[1], p[2] << 8 | p[3])) break;
+		}
+	}
+
+	void set_calibration_image(uint8_t i, uint16_t x, uint16_t y) {
+		if (i < max_calib_points) {
+			uint8_t* p = &calib_image[1 + 4*i];
+			p[0] = x >> 8;
+			p[1] = x & 0xff;
+			p[2] = y >> 8;
+			p[3] = y & 0xff;
+		}
+		calib_image[0] = ux.get_calibration_count();
+		calib_next  = 0;
+		calib_dirty = true;
+	}
+
+	/* Writes the next byte of the calibration image which differs from
+	   the EEPROM, if the EEPROM is ready, hence never waits for a write
+	   (~3.4 ms each). The number of points is written last, so an
+	   interrupted update is rejected when read (points not ascending)
+	   or keeps the old number of points. */
+	void store_calibration(void) {
+		if (not calib_dirty or not eeprom_is_ready()) return;
+		for (; calib_next < calib_bytes; ++calib_next) {
+			const uint8_t i = (calib_next + 1) % calib_bytes; /* count last */
+			uint8_t* addr = (uint8_t*)eeprom_calib_addr + i;
+			if (eeprom_read_byte(addr) != calib_image[i]) {
+				eeprom_write_byte(addr, calib_image[i]);
+				return;
+			}
+		}
+		calib_dirty = false;
+	}
+
 	inline
 	bool byte_received(void) {
 		bool result = Uart0::read(recv_buffer);
@@ -147,13 +238,28 @@ public:
 			case set_id:
 			case set_pwm_limit:
 			case ext_sensor_request:
+			case set_ext_sensor_prefetch:
+			case set_position_mode:
+			case set_motor_constants:
+			case set_calibration_point:
+			case set_voltage_ext_sensor:
 				return (motor_id == recv_buffer) ? reading : eating;
 
+			/* broadcasts */
+			case discover:
+				discovery_first = recv_buffer;
+				return reading;
+			case set_pwm_limit_all: /* id is don't care */
+				return reading;
+
 			/* responses */
-			case ping_response:           return eating;
-			case set_id_response:         return eating;
-			case data_requested_response: return eating;
-			case ext_sensor_request_resp: return eating;
+			case ping_response:              return eating;
+			case set_id_response:            return eating;
+			case data_requested_response:    return eating;
+			case ext_sensor_request_resp:    return eating;
+			case ext_sensor_request_resp_ts: return eating;
+			case set_calibration_point_response: return eating;
+			case data_ext_sensor_response:   return eating;
 
 			default: /* unknown command */ break;
 		}
@@ -161,16 +267,23 @@ public:
 		return finished;
 	}
 
-	void prepare_data_response(void)
+	void prepare_data_response(uint8_t response_id = 0x80 /* 1000.0000 */)
 	{
-		send.add_byte(0x80); /* 1000.0000 */
+		send.add_byte(response_id);
 		send.add_byte(motor_id);
 		send.add_word(ux.get_position());
 		send.add_word(ux.get_current());
 		send.add_word(ux.get_velocity());
 		send.add_word(ux.get_voltage_supply());
 		send.add_word(ux.get_temperature());
-		//TODO: integrate voltage_back_emf again
+		{
+			const uint32_t p = ux.get_position_multiturn();
+			send.add_word(p >> 16);
+			send.add_word(p & 0xffff);
+		}
+		send.add_word(ux.get_voltage_back_emf());
+		send.add_word(ux.get_velocity_fused());
+		send.add_word(ux.get_position_calibrated());
 		//TODO: integrate state/context fields
 		//TODO: integrate error/status codes
 	}
@@ -192,6 +305,24 @@ public:
 				prepare_data_response();
 				break;
 
+			case set_voltage_ext_sensor:
+				/* set voltage and respond data along with the
+				   external sensor's values in one transaction */
+				ux.set_target_pwm(target_pwm);
+				ux.set_target_dir(target_dir);
+				ux.enable();
+				prepare_data_response(0x81); /* 1000.0001 */
+				{
+					auto const& s = exts.get_values();
+					send.add_word(s.x);
+					send.add_word(s.y);
+					send.add_word(s.z);
+					send.add_word(s.timestamp); /* 0 unless prefetching */
+				}
+				if (not exts.is_prefetching()) /* started by the tick otherwise */
+					exts.restart();
+				break;
+
 			case toggle_led: //TODO: apply pwm to LED
 				if (led_state) {
 					led::yellow::reset();
@@ -216,22 +347,67 @@ public:
 				break;
 
 			case set_pwm_limit:
+			case set_pwm_limit_all:
 				ux.set_pwm_limit(target_pwm_max);
 				/* no response needed */
 				break;
 
+			case discover:
+				if (motor_id < discovery_first or motor_id - discovery_first >= discovery_count)
+					break; /* not addressed */
+				/* responded in own slot, see respond_discovery() */
+				discovery_due = ticks + discovery_slot_ticks * (motor_id - discovery_first) + 1;
+				discovery_pending = true;
+				break;
+
 			case ext_sensor_request:
-				send.add_byte(0x41); /* 0100.0001 */
+				/* when prefetching, the latest completed sample
+				   is sent along with the tick it was taken at */
+				send.add_byte(exts.is_prefetching() ? 0x42   /* 0100.0010 */
+				                                    : 0x41); /* 0100.0001 */
 				send.add_byte(motor_id);
 				{
 					auto const& s = exts.get_values();
 					send.add_word(s.x);
 					send.add_word(s.y);
 					send.add_word(s.z);
+					if (exts.is_prefetching())
+						send.add_word(s.timestamp);
 				}
-				exts.restart();
+				if (not exts.is_prefetching()) /* started by the tick otherwise */
+					exts.restart();
 				break;
 
+			case set_ext_sensor_prefetch:
+				exts.set_prefetch(target_prefetch);
+				/* no response needed */
+				break;
+
+			case set_position_mode:
+				ux.set_multiturn(target_position_mode & 0x1);
+				/* no response needed */
+				break;
+
+			case set_motor_constants:
+				ux.set_motor_constants( get_cmd_word(0)  /* back-EMF offset */
+				                      , get_cmd_word(2)  /* back-EMF gain   */
+				                      , cmd_data[4] );   /* fusion shift    */
+				/* no response needed */
+				break;
+
+			case set_calibration_point:
+			{	/* index, adc reading, calibrated value.
+				   Points out of order clear the table, the
+				   response contains the resulting number of points */
+				const uint8_t idx = cmd_data[0];
+				ux.set_calibration_point(idx, get_cmd_word(1), get_cmd_word(3));
+				set_calibration_image(idx, get_cmd_word(1), get_cmd_word(3));
+				send.add_byte(0x31); /* 0011.0001 */
+				send.add_byte(motor_id);
+				send.add_byte(ux.get_calibration_count());
+				break;
+			}
+
 			default: /* unknown command */
 				assert(false, 2);
 				break;
@@ -248,6 +424,7 @@ public:
 		switch(cmd_id)
 		{
 			case set_voltage:
+			case set_voltage_ext_sensor:
 				target_pwm = recv_buffer;
 				return verifying;
 
@@ -259,19 +436,47 @@ public:
 				else return error;
 
 			case set_pwm_limit:
+			case set_pwm_limit_all:
 				target_pwm_max = recv_buffer;
 				return verifying;
 
+			case discover:
+				discovery_count = (recv_buffer < max_discovery_count) ? recv_buffer : max_discovery_count;
+				return verifying;
+
 			case ext_sensor_request:
 				//ext_sensor_id = recv_buffer; TODO handle sensor id
 				return verifying;
 
+			case set_ext_sensor_prefetch:
+				target_prefetch = recv_buffer;
+				return verifying;
+
+			case set_position_mode:
+				target_position_mode = recv_buffer;
+				return verifying;
+
+			case set_motor_constants:
+			case set_calibration_point:
+				return read_cmd_data(5);
+
 			default: /* unknown command */ break;
 		}
 		assert(false, 4);
 		return finished;
 	}
 
+	command_state_t read_cmd_data(uint8_t num_bytes)
+	{
+		assert(num_bytes <= max_cmd_data, 6);
+		cmd_data[cmd_bytes_received++] = recv_buffer;
+		return (cmd_bytes_received < num_bytes) ? reading : verifying;
+	}
+
+	uint16_t get_cmd_word(uint8_t offset) const {
+		return (cmd_data[offset] << 8) | cmd_data[offset+1];
+	}
+
 	command_state_t eating_others_data()
 	{
 		++num_bytes_eaten;
@@ -289,13 +494,29 @@ public:
 			case set_id:
 			case set_pwm_limit:
 			case ext_sensor_request:
+			case set_ext_sensor_prefetch:
+			case set_position_mode:
+			case set_voltage_ext_sensor:
+				return (num_bytes_eaten <  2) ? eating : finished;
+
+			case set_motor_constants:
+			case set_calibration_point:
+				return (num_bytes_eaten <  6) ? eating : finished;
+
+			case set_calibration_point_response:
 				return (num_bytes_eaten <  2) ? eating : finished;
 
 			case ext_sensor_request_resp:
 				return (num_bytes_eaten <  7) ? eating : finished;
 
+			case ext_sensor_request_resp_ts:
+				return (num_bytes_eaten <  9) ? eating : finished;
+
 			case data_requested_response:
-				return (num_bytes_eaten < 11) ? eating : finished;
+				return (num_bytes_eaten < 21) ? eating : finished;
+
+			case data_ext_sensor_response:
+				return (num_bytes_eaten < 29) ? eating : finished;
 
 			default: /* unknown command */ break;
 		}
@@ -336,16 +557,28 @@ public:
 			case 0xB0: /* 1011.0000 */ //fall through
 			case 0xB1: /* 1011.0001 */ cmd_id = set_voltage;
 			                           target_dir = recv_buffer & 0x1;   break;
+			case 0xB2: /* 1011.0010 */ //fall through
+			case 0xB3: /* 1011.0011 */ cmd_id = set_voltage_ext_sensor;
+			                           target_dir = recv_buffer & 0x1;   break;
 			case 0xE0: /* 1110.0000 */ cmd_id = ping;                    break;
 			case 0xA0: /* 1010.0000 */ cmd_id = set_pwm_limit;           break;
+			case 0xA1: /* 1010.0001 */ cmd_id = set_pwm_limit_all;       break;
+			case 0xE2: /* 1110.0010 */ cmd_id = discover;                break;
 			case 0x70: /* 0111.0000 */ cmd_id = set_id;                  break;
 			case 0x40: /* 0100.0000 */ cmd_id = ext_sensor_request;      break;
+			case 0x50: /* 0101.0000 */ cmd_id = set_ext_sensor_prefetch; break;
+			case 0x90: /* 1001.0000 */ cmd_id = set_position_mode;       break;
+			case 0x60: /* 0110.0000 */ cmd_id = set_motor_constants;     break;
+			case 0x30: /* 0011.0000 */ cmd_id = set_calibration_point;   break;
 
 			/* read but ignore sensorimotor responses */
 			case 0xE1: /* 1110.0001 */ cmd_id = ping_response;           break;
 			case 0x71: /* 0111.0001 */ cmd_id = set_id_response;         break;
 			case 0x80: /* 1000.0000 */ cmd_id = data_requested_response; break;
-			case 0x41: /* 0400.0001 */ cmd_id = ext_sensor_request_resp; break;
+			case 0x81: /* 1000.0001 */ cmd_id = data_ext_sensor_response; break;
+			case 0x41: /* 0100.0001 */ cmd_id = ext_sensor_request_resp; break;
+			case 0x42: /* 0100.0010 */ cmd_id = ext_sensor_request_resp_ts; break;
+			case 0x31: /* 0011.0001 */ cmd_id = set_calibration_point_response; break;
 
 			default: /* unknown command */
 				return error;
@@ -399,6 +632,7 @@ public:
 				cmd_id = no_command;
 				cmd_state = syncing;
 				num_bytes_eaten = 0;
+				cmd_bytes_received = 0;
 				recv_checksum = 0;
 				assert(sync_state == false, 55);
 				/* anything else todo? */
@@ -419,9 +653,25 @@ public:
 		return true; // continue
 	}
 
+	/* sends the delayed response to a discovery broadcast,
+	   when the slot has come and no command is being received */
+	void respond_discovery(void) {
+		if (not discovery_pending or cmd_state != syncing or sync_state) return;
+		if ((int16_t) (ticks - discovery_due) < 0) return;
+		send.add_byte(0xE1); /* 1110.0001 */
+		send.add_byte(motor_id);
+		send.flush();
+		discovery_pending = false;
+	}
+
+	/* call once per cycle of the 1kHz loop */
+	void tick(void) { ++ticks; }
+
 	inline
 	void step() {
 		while(receive_command());
+		respond_discovery();
+		store_calibration();
 	}
 };
 
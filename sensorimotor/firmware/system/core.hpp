@@ -11,82 +11,111 @@
 
 #include <system/adc.hpp>
 #include <common/temperature.hpp>
+#include <common/multiturn.hpp>
+#include <common/differentiator.hpp>
+#include <common/velocity_fusion.hpp>
+#include <common/calibration.hpp>
 
 namespace supreme {
 
 namespace defaults {
 	const uint8_t pwm_limit = 32; /* 12,5% duty cycle */
 
-	const int16_t lut_1byX[501] = { /* TODO: reduce memory footprint of this LUT */
-	   0, 1000, 500, 333, 250, 200, 166, 142, 125, 111, 100, 90, 83, 76, 71, 66, 62, 58, 55, 52, 50, 47, 45, 43, 41, 40, 38, 37, 35, 34, 33, 32, 31, 30, 29, 28, 27, 27, 26, 25, 25, 24, 23, 23, 22, 22, 21, 21, 20, 20, 20, 19, 19, 18, 18, 18, 17, 17, 17, 16, 16, 16, 16, 15, 15, 15, 15, 14, 14, 14, 14, 14, 13, 13, 13, 13, 13, 12, 12, 12, 12, 12, 12, 12, 11, 11, 11, 11, 11, 11, 11, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2
-	};
+	/* potentiometer readings outside this range are taken as being
+	   in the gap of the pot and are ignored for multi-turn tracking */
+	const uint16_t pot_gap_lo = 8;
+	const uint16_t pot_gap_hi = 1015;
+
+	/* tap distance of the velocity differentiator in cycles (ms) */
+	const uint8_t velocity_taps_ms = 8;
+
+	/* max. number of breakpoints of the position calibration table */
+	const uint8_t calibration_points = 16;
 }
 
 class Sensors {
 public:
-	uint16_t position         = 0;
-	uint16_t current          = 0;
-	uint16_t voltage_back_emf = 0;
-	uint16_t voltage_supply   = 0;
-	uint16_t temperature      = 0;
-
-	Sensors() { init(); }
+	uint16_t position           = 0;
+	 int32_t position_multiturn = 0;
+	 int16_t position_calibrated = 0;
+	uint16_t current            = 0;
+	uint16_t voltage_back_emf   = 0;
+	uint16_t voltage_supply     = 0;
+	uint16_t temperature        = 0;
+	 int16_t velocity           = 0;
+	 int16_t velocity_fused     = 0;
+
+	Sensors() : turns(defaults::pot_gap_lo, defaults::pot_gap_hi) { init(); }
 
 	void init(void)
 	{
-		for (uint8_t i = 0; i < 6; ++i)
-			f[i] = (int16_t) adc::result[adc::position];
+		turns.init(adc::result[adc::position]);
+		f = turns.get_counts() * 64;
+		diff.init(f);
+		velocity = 0;
+		velocity_fused = 0;
+	}
+
+	/* set motor constants for back-EMF based velocity estimation */
+	void set_motor_constants(uint16_t offset, int16_t gain, uint8_t shift) {
+		fusion.set_constants(offset, gain, shift);
+	}
+
+	/* set breakpoint i of the position calibration table,
+	   this truncates the table to i+1 breakpoints */
+	bool set_calibration_point(uint8_t i, uint16_t x, int16_t y) {
+		return calib.set_point(i, x, y);
+	}
+	uint8_t get_calibration_count(void) const { return calib.get_count(); }
+
+	/* enable unwrapping of the position across turns,
+	   (re)starts turn counting from the current position */
+	void set_multiturn(bool enable) {
+		multiturn = enable;
+		turns.init(adc::result[adc::position]);
 	}
 
 	void step(void)
 	{
-		position         = adc::result[adc::position] << 6; /* promote to upper bits and lowpass-filter */
-		current          = adc::result[adc::current];
-		voltage_back_emf = adc::result[adc::voltage_back_emf];
-		voltage_supply   = adc::result[adc::voltage_supply];
-		temperature      = get_temperature_celsius(adc::result[adc::temperature]);
-
-		/* increment dt for velocity averaging.
-		   count time steps up to 1000ms.
-		*/
-		if (dt < 1000) ++dt; // increment time delta for differentiator
-
-		/* additional simple IIR lowpass filter */
-		f[0] = (int16_t) (f[0] + adc::result[adc::position]) >> 1;
+		if (multiturn) turns.step(adc::result[adc::position]);
+		else           turns.init(adc::result[adc::position]);
+
+		position           = adc::result[adc::position] << 6; /* promote to upper bits and lowpass-filter */
+		position_multiturn = turns.get();
+		position_calibrated = calib.apply(adc::result[adc::position]);
+		current            = adc::result[adc::current];
+		voltage_back_emf   = adc::result[adc::voltage_back_emf];
+		voltage_supply     = adc::result[adc::voltage_supply];
+		temperature        = get_temperature_celsius(adc::result[adc::temperature]);
+
+		/* additional simple IIR lowpass filter on the unwrapped position,
+		   promoted by factor of 64 (Q6) for sub-LSB resolution.
+		   Note: wraps around at 16 bit, differences stay valid */
+		f += (int16_t) ((uint16_t) (turns.get_counts() * 64) - f) >> 1;
+
+		/* differentiate with fixed sample interval of 1ms,
+		   velocity is scaled to 16 * d(pos)/dt in 10 bit units per second */
+		velocity = saturate(diff.step(f) * 125 / (8 * defaults::velocity_taps_ms));
+
+		/* fuse with back-EMF, same scaling */
+		velocity_fused = fusion.step(velocity, voltage_back_emf);
 	}
 
-	/* get velocity and restart averaging */
-	uint16_t restart_velocity_sampling(void) {
-		/* shift velocity regs*/
-		f[5] = f[4];
-		f[4] = f[3];
-		f[3] = f[2];
-		f[2] = f[1];
-		f[1] = f[0];
-
-		if (dt == 1000) { dt = 0; return 0; } // return 0, if time delta is too long.
-
-		int16_t g = (dt < 500) ? defaults::lut_1byX[dt] : 1;
-
-		/* Differentiation filter with noise reduction
-		   optimized for integer arithmetics:
-		   See Paper: "One-Sided Differentiators" by Pavel Holoborodko
-		   http://www.holoborodko.com/pavel/ August 24, 2009
-		   Note: Velocity is dp/(dt*4) to allow for enough headroom.
-		         Position is promoted by factor of 64 (see above),
-		         and hence the divisor of 16 of this filter (see paper) omitted.
-		*/
-		int16_t velocity = ((int32_t)  f[0] - f[5]
-		                        + 3 * (f[1] - f[4])
-		                        + 2 * (f[2] - f[3])) * g;
-
-		dt = 0; // reset time delta
-		return velocity;
+private:
+	static int16_t saturate(int32_t v) {
+		if (v >  32767) return  32767;
+		if (v < -32767) return -32767;
+		return v;
 	}
 
-private:
-	uint16_t dt = 1000;
-	 int16_t f[6];
+	uint16_t f = 0;
+	Differentiator<defaults::velocity_taps_ms> diff;
+	VelocityFusion fusion;
+
+	Multiturn turns;
+	bool      multiturn = false;
+
+	Calibration<defaults::calibration_points> calib;
 };
 
 template <typename MotorDriverType>
@@ -130,6 +159,14 @@ public:
 	}
 
 	void init_sensors(void) { sensors.init(); }
+	void set_multiturn(bool enable) { sensors.set_multiturn(enable); }
+	void set_motor_constants(uint16_t offset, int16_t gain, uint8_t shift) {
+		sensors.set_motor_constants(offset, gain, shift);
+	}
+	bool set_calibration_point(uint8_t i, uint16_t x, int16_t y) {
+		return sensors.set_calibration_point(i, x, y);
+	}
+	uint8_t get_calibration_count(void) const { return sensors.get_calibration_count(); }
 
 	void step(void) {
 		apply_target_values();
@@ -149,7 +186,10 @@ public:
 	bool is_enabled() const { return enabled; }
 
 	uint16_t get_position        () const { return sensors.position; }
-	uint16_t get_velocity        ()       { return sensors.restart_velocity_sampling(); }
+	 int32_t get_position_multiturn() const { return sensors.position_multiturn; }
+	 int16_t get_position_calibrated() const { return sensors.position_calibrated; }
+	uint16_t get_velocity        () const { return sensors.velocity; }
+	uint16_t get_velocity_fused  () const { return sensors.velocity_fused; }
 	uint16_t get_current         () const { return sensors.current; }
 	uint16_t get_voltage_back_emf() const { return sensors.voltage_back_emf; }
 	uint16_t get_voltage_supply  () const { return sensors.voltage_supply; }
@@ -1,22 +1,38 @@
-
 #include <stdio.h>
+#include <string.h>
 
 typedef unsigned char uint8_t;
 
-uint8_t motor_id = 23; //TODO make array
+uint8_t motor_id = 23;
+uint8_t eeprom_data[1024] = {0};
+bool eeprom_ready = true;       /* false: a write is in progress */
+unsigned eeprom_writes = 0;
 
 
 void eeprom_busy_wait(void) {}
-
-uint8_t eeprom_read_byte(uint8_t* ) {
-//	printf("rd motor id: %u\n", motor_id & 0x7F);
-	return motor_id;
+bool eeprom_is_ready(void) { return eeprom_ready; }
+
+uint8_t eeprom_read_byte(uint8_t* addr) {
+	if (addr == (uint8_t*)23) {
+//		printf("rd motor id: %u\n", motor_id & 0x7F);
+		return motor_id;
+	}
+	return eeprom_data[(size_t) addr % sizeof(eeprom_data)];
 }
 
-void eeprom_write_byte(uint8_t*, uint8_t b) {
-	motor_id = b;
-//	printf("wr motor id: %u\n", motor_id & 0x7F);
+void eeprom_write_byte(uint8_t* addr, uint8_t b) {
+	if (addr == (uint8_t*)23) {
+		motor_id = b;
+//		printf("wr motor id: %u\n", motor_id & 0x7F);
+		return;
+	}
+	eeprom_data[(size_t) addr % sizeof(eeprom_data)] = b;
+	++eeprom_writes;
 }
 
 void set_motor_id(uint8_t id) { motor_id = id; }
-
+void reset_eeprom(void) {
+	memset(eeprom_data, 0, sizeof(eeprom_data));
+	eeprom_ready = true;
+	eeprom_writes = 0;
+}
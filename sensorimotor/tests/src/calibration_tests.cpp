@@ -0,0 +1,89 @@
+#include "./catch_1.10.0.hpp"
+#include <cmath>
+#include <common/calibration.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "calibration table with less than two points is the identity", "[calibration]")
+{
+	Calibration<16> c;
+	REQUIRE( not c.is_valid() );
+	REQUIRE( c.apply(   0) ==    0 );
+	REQUIRE( c.apply( 512) ==  512 );
+	REQUIRE( c.apply(1023) == 1023 );
+
+	REQUIRE( c.set_point(0, 100, -500) );
+	REQUIRE( c.get_count() == 1 );
+	REQUIRE( not c.is_valid() );
+	REQUIRE( c.apply(512) == 512 );
+}
+
+TEST_CASE( "calibration table interpolates linearly and clips at the ends", "[calibration]")
+{
+	Calibration<16> c;
+	REQUIRE( c.set_point(0, 100, -1000) );
+	REQUIRE( c.set_point(1, 300,  1000) );
+	REQUIRE( c.set_point(2, 900,  1600) );
+	REQUIRE( c.is_valid() );
+	REQUIRE( c.get_count() == 3 );
+
+	/* breakpoints */
+	REQUIRE( c.apply(100) == -1000 );
+	REQUIRE( c.apply(300) ==  1000 );
+	REQUIRE( c.apply(900) ==  1600 );
+
+	/* segments */
+	REQUIRE( c.apply(200) ==     0 );
+	REQUIRE( c.apply(150) ==  -500 );
+	REQUIRE( c.apply(600) ==  1300 );
+
+	/* clipping */
+	REQUIRE( c.apply(   0) == -1000 );
+	REQUIRE( c.apply(1023) ==  1600 );
+}
+
+TEST_CASE( "calibration table matches reference over full range", "[calibration]")
+{
+	Calibration<16> c;
+	/* a non-linear curve sampled at 16 breakpoints */
+	uint16_t x[16];
+	int16_t  y[16];
+	for (unsigned i = 0; i < 16; ++i) {
+		x[i] = 8 + i * 67;
+		y[i] = (int32_t) (i * i) * 100 - 9000;
+		REQUIRE( c.set_point(i, x[i], y[i]) );
+	}
+	REQUIRE( c.get_count() == 16 );
+
+	for (unsigned i = 0; i < 15; ++i)
+		for (uint16_t a = x[i]; a <= x[i+1]; ++a) {
+			const double ref = y[i] + (double) (a - x[i]) * (y[i+1] - y[i]) / (x[i+1] - x[i]);
+			/* truncation plus Q8 slope resolution */
+			REQUIRE( std::abs(c.apply(a) - ref) <= 2.0 );
+		}
+}
+
+TEST_CASE( "calibration table is invalidated when not ascending", "[calibration]")
+{
+	Calibration<16> c;
+	REQUIRE( c.set_point(0, 100, 0) );
+	REQUIRE( c.set_point(1, 200, 100) );
+	REQUIRE( c.is_valid() );
+
+	REQUIRE( not c.set_point(2, 200, 300) );
+	REQUIRE( c.get_count() == 0 );
+	REQUIRE( c.apply(150) == 150 );
+
+	/* index out of range is rejected, table unchanged */
+	REQUIRE( c.set_point(0, 100, 0) );
+	REQUIRE( c.set_point(1, 200, 100) );
+	REQUIRE( not c.set_point(16, 300, 200) );
+	REQUIRE( c.get_count() == 2 );
+
+	/* re-uploading the first point truncates the table */
+	REQUIRE( c.set_point(0, 10, 10) );
+	REQUIRE( c.get_count() == 1 );
+}
+
+}} /* namespace supreme::local_tests */
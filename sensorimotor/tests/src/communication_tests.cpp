@@ -186,7 +186,7 @@ TEST_CASE( "data request command can be received and is responded", "[communicat
 	REQUIRE( com.get_state() == com_t::command_state_t::syncing );
 	REQUIRE( com.get_errors() == 0 );
 
-	REQUIRE( Uart0::recv_buffer.size() == 15 );
+	REQUIRE( Uart0::recv_buffer.size() == 25 );
 	REQUIRE( Uart0::buffer_flushed );
 
 	REQUIRE( Uart0::recv_buffer[ 0] == 0xff );
@@ -203,6 +203,16 @@ TEST_CASE( "data request command can be received and is responded", "[communicat
 	REQUIRE( Uart0::recv_buffer[11] == 0x4B );
 	REQUIRE( Uart0::recv_buffer[12] == 0x5A ); // temperature
 	REQUIRE( Uart0::recv_buffer[13] == 0x5B );
+	REQUIRE( Uart0::recv_buffer[14] == 0x7A ); // multi-turn position
+	REQUIRE( Uart0::recv_buffer[15] == 0x7B );
+	REQUIRE( Uart0::recv_buffer[16] == 0x7C );
+	REQUIRE( Uart0::recv_buffer[17] == 0x7D );
+	REQUIRE( Uart0::recv_buffer[18] == 0x8A ); // voltage back emf
+	REQUIRE( Uart0::recv_buffer[19] == 0x8B );
+	REQUIRE( Uart0::recv_buffer[20] == 0x9A ); // fused velocity
+	REQUIRE( Uart0::recv_buffer[21] == 0x9B );
+	REQUIRE( Uart0::recv_buffer[22] == 0xAA ); // calibrated position
+	REQUIRE( Uart0::recv_buffer[23] == 0xAB );
 
 	REQUIRE( verify_checksum(Uart0::recv_buffer) );
 }
@@ -232,7 +242,7 @@ TEST_CASE( "valid commands and responses for other motors is ignored", "[communi
 
 	/* msg responses from different motor ids */
 	std::vector<uint8_t> re_ping         = { 0xe1, 42 };
-	std::vector<uint8_t> re_data_request = { 0x80, 43, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	std::vector<uint8_t> re_data_request = { 0x80, 43, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 };
 	std::vector<uint8_t> re_set_id       = { 0x71, 13 };
 
 	reset_hardware();
@@ -470,7 +480,7 @@ TEST_CASE( "multiple data requests", "[communication]")
 	std::vector<uint8_t> data_request     = { 0xC0, 42 };
 
 	/* msg responses from different motor ids */
-	std::vector<uint8_t> re_data_request  = { 0x80, 43, 0, 1, 2, 0xff, 0xff, 0xC0, 6, 7, 8, 9 };
+	std::vector<uint8_t> re_data_request  = { 0x80, 43, 0, 1, 2, 0xff, 0xff, 0xC0, 6, 7, 8, 9, 0xff, 0xff, 0x80, 13, 0xff, 0xff, 0xC0, 17, 0xff, 0xff };
 
 	reset_hardware();
 	set_motor_id(23);
@@ -507,7 +517,7 @@ TEST_CASE( "multiple data requests", "[communication]")
 			REQUIRE( Uart0::recv_buffer.size() == 0 );
 			REQUIRE( not Uart0::buffer_flushed );
 		} else {
-			REQUIRE( Uart0::recv_buffer.size() == 15 );
+			REQUIRE( Uart0::recv_buffer.size() == 25 );
 			REQUIRE( Uart0::buffer_flushed );
 		}
 	}
@@ -526,7 +536,7 @@ TEST_CASE( "find valid messages in garbage", "[communication]")
 
 	/* msg responses from different motor ids */
 	std::vector<uint8_t> re_ping         = { 0xe1, 42 };
-	std::vector<uint8_t> re_data_request = { 0x80, 43, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	std::vector<uint8_t> re_data_request = { 0x80, 43, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 };
 	std::vector<uint8_t> re_set_id       = { 0x71, 13 };
 
 	std::vector<uint8_t> garbage      = { 0xff, 0xdd, 0xff, 0x34, 0xe1, 23, 0xff, 0xfe, 0x03 };
@@ -564,7 +574,7 @@ TEST_CASE( "find valid messages in garbage", "[communication]")
 	REQUIRE( com.get_state() == com_t::command_state_t::syncing );
 	REQUIRE( com.get_errors() == 0 );
 
-	REQUIRE( Uart0::recv_buffer.size() == 5 + 15 + 5/* TODO: detect cmd response */ );
+	REQUIRE( Uart0::recv_buffer.size() == 5 + 25 + 5/* TODO: detect cmd response */ );
 	REQUIRE( Uart0::buffer_flushed );
 }
 
@@ -651,7 +661,7 @@ TEST_CASE( "set_voltage command can be received, pwm and direction is set and co
 	REQUIRE( com.get_errors() == 0 );
 
 	/* received data package */
-	REQUIRE( Uart0::recv_buffer.size() == 15 );
+	REQUIRE( Uart0::recv_buffer.size() == 25 );
 	REQUIRE( Uart0::recv_buffer[2] == 0x80 );
 	REQUIRE( Uart0::recv_buffer[3] == 23 );
 	REQUIRE( Uart0::buffer_flushed );
@@ -710,4 +720,402 @@ TEST_CASE( "ext_sensor_request command can be received and is responded with dat
 	REQUIRE( Uart0::buffer_flushed );
 }
 
+TEST_CASE( "ext_sensor_prefetch command enables prefetching and timestamped responses", "[communication]")
+{
+	reset_hardware();
+
+	using core_t = test_sensorimotor_core;
+	using exts_t = ExternalSensor;
+	using com_t = supreme::communication_ctrl<core_t, exts_t>;
+
+	core_t ux;
+	exts_t ex;
+	com_t com(ux, ex);
+
+	REQUIRE( com.get_motor_id() == 23 );
+
+	std::vector<uint8_t> prefetch_cmd       = { 0x50, /*motor_id=*/23, /*divider=*/10 };
+	std::vector<uint8_t> ext_sensor_req_cmd = { 0x40, /*motor_id=*/23, /*sensor_id=*/01 };
+
+	send(prefetch_cmd);
+	REQUIRE( not ex.is_prefetching() );
+	com.step();
+
+	REQUIRE( ex.is_prefetching() );
+	REQUIRE( ex.divider == 10 );
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 0 ); // no response
+	REQUIRE( not Uart0::buffer_flushed );
+
+	send(ext_sensor_req_cmd);
+	com.step();
+
+	REQUIRE( ex.ext_sensor_requests == 0 ); // readout is not restarted on request
+	REQUIRE( com.get_state() == com_t::command_state_t::syncing );
+	REQUIRE( com.get_errors() == 0 );
+
+	/* received timestamped sensor data package */
+	REQUIRE( Uart0::recv_buffer.size() == 13 );
+	REQUIRE( Uart0::recv_buffer[2] == 0x42 );
+	REQUIRE( Uart0::recv_buffer[3] == 23 );
+	REQUIRE( get_signed_word( Uart0::recv_buffer[4]
+	                        , Uart0::recv_buffer[5] ) == -1337 );
+	REQUIRE( Uart0::recv_buffer[10] == 0x6A ); // timestamp
+	REQUIRE( Uart0::recv_buffer[11] == 0x6B );
+	REQUIRE( verify_checksum(Uart0::recv_buffer) );
+	REQUIRE( Uart0::buffer_flushed );
+
+	/* neither by the combined voltage and ext. sensor command */
+	reset_hardware();
+	send({ 0xB2, 23, 10 });
+	com.step();
+	REQUIRE( ex.ext_sensor_requests == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 33 );
+	REQUIRE( Uart0::recv_buffer[30] == 0x6A ); // timestamp
+	REQUIRE( Uart0::recv_buffer[31] == 0x6B );
+
+	/* switch back to restart on request */
+	prefetch_cmd[2] = 0;
+	reset_hardware();
+	send(prefetch_cmd);
+	send(ext_sensor_req_cmd);
+	com.step();
+
+	REQUIRE( not ex.is_prefetching() );
+	REQUIRE( ex.ext_sensor_requests == 1 );
+	REQUIRE( Uart0::recv_buffer.size() == 11 );
+	REQUIRE( Uart0::recv_buffer[2] == 0x41 );
+}
+
+TEST_CASE( "ext sensor commands and responses for other motors are ignored", "[communication]")
+{
+	using core_t = test_sensorimotor_core;
+	using exts_t = ExternalSensor;
+	using com_t = supreme::communication_ctrl<core_t, exts_t>;
+
+	std::vector<uint8_t> prefetch       = { 0x50, 42, 1 };
+	std::vector<uint8_t> ext_sensor_req = { 0x40, 42, 1 };
+	std::vector<uint8_t> re_ext_sensor  = { 0x41, 42, 0, 1, 2, 3, 4, 5 };
+	std::vector<uint8_t> re_ext_ts      = { 0x42, 42, 0, 1, 2, 3, 4, 5, 0xff, 0xff };
+
+	reset_hardware();
+	core_t ux;
+	exts_t ex;
+	com_t com(ux, ex);
+	REQUIRE( com.get_motor_id() == 23 );
+
+	for (auto const& cmd : { prefetch, ext_sensor_req, re_ext_sensor, re_ext_ts } )
+	{
+		reset_hardware();
+		send(cmd);
+		com.step();
+
+		REQUIRE( Uart0::send_queue.empty() );
+		REQUIRE( com.get_state() == com_t::command_state_t::syncing );
+		REQUIRE( com.get_errors() == 0 );
+		REQUIRE( Uart0::recv_buffer.size() == 0 );
+		REQUIRE( not ex.is_prefetching() );
+	}
+}
+
+TEST_CASE( "set_position_mode command enables multi-turn tracking and is NOT responded", "[communication]")
+{
+	reset_hardware();
+
+	using core_t = test_sensorimotor_core;
+	using exts_t = ExternalSensor;
+	using com_t = supreme::communication_ctrl<core_t, exts_t>;
+
+	core_t ux;
+	exts_t ex;
+	com_t com(ux, ex);
+
+	REQUIRE( com.get_motor_id() == 23 );
+	REQUIRE( not ux.multiturn );
+
+	send({ 0x90, 23, 0x01 });
+	com.step();
+
+	REQUIRE( ux.multiturn );
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 0 );
+	REQUIRE( not Uart0::buffer_flushed );
+
+	send({ 0x90, 23, 0x00 });
+	send({ 0x90, 42, 0x01 }); // other motor
+	com.step();
+
+	REQUIRE( not ux.multiturn );
+	REQUIRE( com.get_state() == com_t::command_state_t::syncing );
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 0 );
+}
+
+TEST_CASE( "set_motor_constants command can be received, constants are set and command is NOT responded", "[communication]")
+{
+	reset_hardware();
+
+	using core_t = test_sensorimotor_core;
+	using exts_t = ExternalSensor;
+	using com_t = supreme::communication_ctrl<core_t, exts_t>;
+
+	core_t ux;
+	exts_t ex;
+	com_t com(ux, ex);
+
+	REQUIRE( com.get_motor_id() == 23 );
+
+	/* constants for other motor are ignored */
+	send({ 0x60, 42, 0x02, 0x00, 0xff, 0xff, 7 });
+	com.step();
+	REQUIRE( ux.bemf_gain == 0 );
+	REQUIRE( com.get_errors() == 0 );
+
+	send({ 0x60, 23, 0x02, 0x01, 0xfe, 0xd4, 5 });
+	com.step();
+
+	REQUIRE( ux.bemf_offset  == 0x0201 );
+	REQUIRE( ux.bemf_gain    == -300 );
+	REQUIRE( ux.fusion_shift == 5 );
+
+	REQUIRE( Uart0::send_queue.empty() );
+	REQUIRE( com.get_state() == com_t::command_state_t::syncing );
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 0 );
+	REQUIRE( not Uart0::buffer_flushed );
+
+	/* next command is processed as usual */
+	send({ 0xe0, 23 });
+	com.step();
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 5 );
+}
+
+TEST_CASE( "set_calibration_point command is received, points are set, stored and responded", "[communication]")
+{
+	reset_hardware();
+	reset_eeprom();
+
+	using core_t = test_sensorimotor_core;
+	using exts_t = ExternalSensor;
+	using com_t = supreme::communication_ctrl<core_t, exts_t>;
+
+	core_t ux;
+	exts_t ex;
+	com_t com(ux, ex);
+
+	REQUIRE( com.get_motor_id() == 23 );
+	REQUIRE( ux.calib_count == 0 );
+
+	/* points and responses of other motors are ignored */
+	send({ 0x30, 42, 0, 0x00, 0x10, 0xff, 0x38 });
+	send({ 0x31, 42, 1 });
+	com.step();
+	REQUIRE( ux.calib_count == 0 );
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 0 );
+
+	send({ 0x30, 23, 0, 0x00, 0x10, 0xff, 0x38 }); /* 16 -> -200 */
+	com.step();
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 6 );
+	REQUIRE( Uart0::recv_buffer[2] == 0x31 );
+	REQUIRE( Uart0::recv_buffer[3] == 23 );
+	REQUIRE( Uart0::recv_buffer[4] == 1 );
+	REQUIRE( verify_checksum(Uart0::recv_buffer) );
+
+	/* points are applied right away, the eeprom is written in the
+	   background, at most one byte per step and only when ready */
+	REQUIRE( ux.calib_count == 1 );
+	REQUIRE( eeprom_writes == 1 );
+	eeprom_ready = false;
+
+	Uart0::recv_buffer.clear();
+	send({ 0x30, 23, 1, 0x03, 0xf0, 0x23, 0x28 }); /* 1008 -> 9000 */
+	com.step();
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 6 );
+	REQUIRE( Uart0::recv_buffer[4] == 2 );
+
+	REQUIRE( ux.calib_count == 2 );
+	REQUIRE( ux.calib_x[0] ==   16 );
+	REQUIRE( ux.calib_y[0] == -200 );
+	REQUIRE( ux.calib_x[1] == 1008 );
+	REQUIRE( ux.calib_y[1] == 9000 );
+
+	com.step();
+	REQUIRE( eeprom_writes == 1 ); /* busy */
+	eeprom_ready = true;
+
+	/* 4 bytes per point (zero bytes equal the cleared eeprom), count last */
+	unsigned steps = 0;
+	for (unsigned writes = eeprom_writes; steps < 20; ++steps) {
+		com.step();
+		REQUIRE( eeprom_writes - writes <= 1 );
+		writes = eeprom_writes;
+	}
+	REQUIRE( eeprom_writes == 8 );
+	REQUIRE( eeprom_data[32] == 2 );
+
+	/* table is restored from eeprom */
+	core_t ux2;
+	com_t com2(ux2, ex);
+	REQUIRE( ux2.calib_count == 2 );
+	REQUIRE( ux2.calib_x[0] ==   16 );
+	REQUIRE( ux2.calib_y[0] == -200 );
+	REQUIRE( ux2.calib_x[1] == 1008 );
+	REQUIRE( ux2.calib_y[1] == 9000 );
+
+	/* invalid index is responded with unchanged count */
+	Uart0::recv_buffer.clear();
+	send({ 0x30, 23, 200, 0x00, 0x00, 0x00, 0x00 });
+	com.step();
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 6 );
+	REQUIRE( Uart0::recv_buffer[4] == 2 );
+}
+
+TEST_CASE( "set_voltage_ext_sensor command is responded with data and ext. sensor values", "[communication]")
+{
+	reset_hardware();
+
+	using core_t = test_sensorimotor_core;
+	using exts_t = ExternalSensor;
+	using com_t = supreme::communication_ctrl<core_t, exts_t>;
+
+	core_t ux;
+	exts_t ex;
+	com_t com(ux, ex);
+
+	REQUIRE( com.get_motor_id() == 23 );
+
+	/* command and response of other motors are ignored */
+	std::vector<uint8_t> re_other = { 0x81, 42 };
+	for (uint8_t i = 0; i < 28; ++i)
+		re_other.push_back(i);
+
+	send({ 0xB2, 42, 99 });
+	send(re_other);
+	com.step();
+	REQUIRE( ux.voltage_pwm == 0 );
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 0 );
+
+	send({ 0xB3, 23, 64 });
+	com.step();
+
+	REQUIRE( ux.voltage_pwm == 64 );
+	REQUIRE( ux.direction == true );
+	REQUIRE( ux.enabled );
+	REQUIRE( ex.ext_sensor_requests == 1 );
+
+	REQUIRE( Uart0::send_queue.empty() );
+	REQUIRE( com.get_state() == com_t::command_state_t::syncing );
+	REQUIRE( com.get_errors() == 0 );
+
+	REQUIRE( Uart0::recv_buffer.size() == 33 );
+	REQUIRE( Uart0::recv_buffer[ 2] == 0x81 );
+	REQUIRE( Uart0::recv_buffer[ 3] == 23 );
+	REQUIRE( Uart0::recv_buffer[ 4] == 0x1A ); // position
+	REQUIRE( Uart0::recv_buffer[ 5] == 0x1B );
+	REQUIRE( Uart0::recv_buffer[22] == 0xAA ); // calibrated position
+	REQUIRE( Uart0::recv_buffer[23] == 0xAB );
+	REQUIRE( get_signed_word( Uart0::recv_buffer[24]
+	                        , Uart0::recv_buffer[25] ) == -1337 );
+	REQUIRE( get_signed_word( Uart0::recv_buffer[26]
+	                        , Uart0::recv_buffer[27] ) == +2342 );
+	REQUIRE( get_signed_word( Uart0::recv_buffer[28]
+	                        , Uart0::recv_buffer[29] ) == -4223 );
+	REQUIRE( Uart0::recv_buffer[30] == 0x6A ); // timestamp
+	REQUIRE( Uart0::recv_buffer[31] == 0x6B );
+	REQUIRE( verify_checksum(Uart0::recv_buffer) );
+}
+
+TEST_CASE( "discover broadcast is responded by addressed motors only", "[communication]")
+{
+	reset_hardware();
+
+	using core_t = test_sensorimotor_core;
+	using exts_t = ExternalSensor;
+	using com_t = supreme::communication_ctrl<core_t, exts_t>;
+
+	core_t ux;
+	exts_t ex;
+	com_t com(ux, ex);
+
+	REQUIRE( com.get_motor_id() == 23 );
+
+	/* id range not including our id */
+	send({ 0xE2, 24, 4 });
+	send({ 0xE2,  0, 23 });
+	com.step();
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 0 );
+
+	for (unsigned t = 0; t < 100; ++t) { com.tick(); com.step(); }
+	REQUIRE( Uart0::recv_buffer.size() == 0 );
+
+	/* id range including our id, responses of others are ignored,
+	   responded without blocking after the first tick of the 4th slot */
+	send({ 0xE2, 20, 5 });
+	send({ 0xE1, 20 });
+	send({ 0xE1, 22 });
+	com.step();
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( com.get_state() == com_t::command_state_t::syncing );
+	for (unsigned t = 0; t < 3*3 + 1; ++t) {
+		REQUIRE( Uart0::recv_buffer.size() == 0 );
+		com.tick();
+		com.step();
+	}
+	REQUIRE( Uart0::recv_buffer.size() == 5 );
+	REQUIRE( Uart0::recv_buffer[2] == 0xE1 );
+	REQUIRE( Uart0::recv_buffer[3] == 23 );
+	REQUIRE( verify_checksum(Uart0::recv_buffer) );
+
+	/* responded once */
+	for (unsigned t = 0; t < 100; ++t) { com.tick(); com.step(); }
+	REQUIRE( Uart0::recv_buffer.size() == 5 );
+
+	/* count is limited to 16 ids, 10..25 */
+	Uart0::recv_buffer.clear();
+	send({ 0xE2, 10, 255 });
+	com.step();
+	unsigned ticks = 0;
+	while (Uart0::recv_buffer.empty() and ticks < 1000) { com.tick(); com.step(); ++ticks; }
+	REQUIRE( ticks == 3*13 + 1 );
+	Uart0::recv_buffer.clear();
+	send({ 0xE2, 0, 255 }); /* 0..15 */
+	com.step();
+	for (unsigned t = 0; t < 100; ++t) { com.tick(); com.step(); }
+	REQUIRE( Uart0::recv_buffer.size() == 0 );
+	REQUIRE( com.get_errors() == 0 );
+}
+
+TEST_CASE( "set_pwm_limit_all broadcast is applied and NOT responded", "[communication]")
+{
+	reset_hardware();
+
+	using core_t = test_sensorimotor_core;
+	using exts_t = ExternalSensor;
+	using com_t = supreme::communication_ctrl<core_t, exts_t>;
+
+	core_t ux;
+	exts_t ex;
+	com_t com(ux, ex);
+
+	REQUIRE( ux.max_pwm == 0 );
+	send({ 0xA1, 127, 200 });
+	com.step();
+	REQUIRE( ux.max_pwm == 200 );
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 0 );
+	REQUIRE( not Uart0::buffer_flushed );
+
+	send({ 0xe0, 23 });
+	com.step();
+	REQUIRE( com.get_errors() == 0 );
+	REQUIRE( Uart0::recv_buffer.size() == 5 );
+}
+
 }} /* namespace supreme::local_tests */
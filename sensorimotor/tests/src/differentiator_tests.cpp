@@ -0,0 +1,56 @@
+#include "./catch_1.10.0.hpp"
+#include <common/differentiator.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "differentiator of constant input is zero", "[differentiator]")
+{
+	Differentiator<4> diff(1234);
+	for (unsigned i = 0; i < 100; ++i)
+		REQUIRE( 0 == diff.step(1234) );
+}
+
+TEST_CASE( "differentiator of ramp is 16 times the slope per tap distance", "[differentiator]")
+{
+	const int16_t slope = 3; /* per sample */
+	Differentiator<4> diff(0);
+
+	/* filling the history */
+	for (unsigned i = 1; i <= 5*4; ++i)
+		diff.step(slope * i);
+
+	for (unsigned i = 5*4+1; i < 200; ++i)
+		REQUIRE( 16 * 4 * slope == diff.step(slope * i) );
+
+	/* same slope backwards */
+	Differentiator<8> back(0);
+	for (unsigned i = 1; i < 200; ++i) {
+		auto v = back.step(-slope * i);
+		if (i > 5*8) REQUIRE( -16 * 8 * slope == v );
+	}
+}
+
+TEST_CASE( "differentiator is not disturbed by wrap-around of samples", "[differentiator]")
+{
+	const int32_t slope = 1000; /* per sample */
+	Differentiator<1> diff(0);
+
+	for (unsigned i = 1; i < 1000; ++i) { /* wraps 16 bit samples several times */
+		auto v = diff.step((uint16_t) (slope * i));
+		if (i > 5) REQUIRE( 16 * slope == v );
+	}
+}
+
+TEST_CASE( "differentiator rejects a single step of noise", "[differentiator]")
+{
+	Differentiator<2> diff(100);
+	diff.step(101); /* one sample outlier */
+	for (unsigned i = 0; i < 20; ++i) {
+		auto v = diff.step(100);
+		REQUIRE( v <= 3 ); /* bounded by the filter's coefficients */
+		REQUIRE( v >= -3 );
+	}
+}
+
+}} /* namespace supreme::local_tests */
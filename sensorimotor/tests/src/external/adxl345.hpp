@@ -0,0 +1,40 @@
+#ifndef TEST_EXTERNAL_ADXL345_HPP
+#define TEST_EXTERNAL_ADXL345_HPP
+
+#include <xpcc/processing/resumable.hpp>
+
+/* replaces the accelerometer driver, every readout
+   yields a new sample (x = number of readouts) */
+namespace xpcc {
+
+template <typename I2cMaster>
+class Adxl345 {
+	uint8_t* data;
+	bool     available = false;
+
+public:
+	static unsigned readouts;
+
+	Adxl345(uint8_t* data, uint8_t /*address*/) : data(data) {}
+
+	bool configure(void) { return true; }
+
+	void readAccelerometer(void) {
+		int16_t* v = reinterpret_cast<int16_t*>(data);
+		v[0] = ++readouts;
+		v[1] = 2 * readouts;
+		v[2] = 3 * readouts;
+		available = true;
+	}
+
+	bool isNewDataAvailable(void) { return available; }
+	ResumableResult<bool> update(void) { return ResumableResult<bool>(); }
+	uint8_t* getData(void) { available = false; return data; }
+};
+
+template <typename I2cMaster>
+unsigned Adxl345<I2cMaster>::readouts = 0;
+
+} /* namespace xpcc */
+
+#endif /* TEST_EXTERNAL_ADXL345_HPP */
@@ -0,0 +1,61 @@
+#include <external/i2c_sensor.hpp>
+#include "./catch_1.10.0.hpp"
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "external sensor is read out on request", "[i2c_sensor]")
+{
+	typedef xpcc::Adxl345<I2cMaster> adxl_t;
+	adxl_t::readouts = 0;
+	ExternalSensor ex;
+	REQUIRE( not ex.is_prefetching() );
+
+	for (uint16_t c = 0; c < 20; ++c) { /* ticks do not start a readout */
+		ex.tick(c);
+		ex.step();
+	}
+	REQUIRE( adxl_t::readouts == 0 );
+
+	ex.restart();
+	ex.step();
+	REQUIRE( adxl_t::readouts == 1 );
+	REQUIRE( ex.get_values().x == 1 );
+	REQUIRE( ex.get_values().z == 3 );
+	REQUIRE( ex.get_values().timestamp == 0 );
+}
+
+TEST_CASE( "external sensor is prefetched every n-th tick with timestamp", "[i2c_sensor]")
+{
+	typedef xpcc::Adxl345<I2cMaster> adxl_t;
+	adxl_t::readouts = 0;
+	ExternalSensor ex;
+
+	ex.set_prefetch(3);
+	REQUIRE( ex.is_prefetching() );
+
+	for (uint16_t c = 100; c < 112; ++c) {
+		ex.tick(c);
+		ex.step();
+		/* started at ticks 102, 105, 108, 111 */
+		REQUIRE( adxl_t::readouts == (c - 100 + 1) / 3 );
+		if (c >= 102)
+			REQUIRE( ex.get_values().timestamp == c - (c - 102) % 3 );
+	}
+	REQUIRE( ex.get_values().x == 4 );
+
+	/* every tick */
+	ex.set_prefetch(1);
+	ex.tick(0xffff);
+	ex.step();
+	REQUIRE( ex.get_values().timestamp == 0xffff );
+	REQUIRE( ex.get_values().x == 5 );
+
+	/* back to readout on request */
+	ex.set_prefetch(0);
+	ex.tick(0);
+	ex.step();
+	REQUIRE( adxl_t::readouts == 5 );
+}
+
+}} /* namespace supreme::local_tests */
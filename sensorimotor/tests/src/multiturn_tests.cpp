@@ -0,0 +1,96 @@
+#include "./catch_1.10.0.hpp"
+#include <common/multiturn.hpp>
+#include <common/differentiator.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "multi-turn position follows single-turn position", "[multiturn]")
+{
+	Multiturn m;
+	m.init(100);
+	REQUIRE( m.get_turns() == 0 );
+	REQUIRE( m.get_counts() == 100 );
+	REQUIRE( m.get() == (100 << 6) );
+
+	m.step(300);
+	REQUIRE( m.get_turns() == 0 );
+	REQUIRE( m.get_counts() == 300 );
+	REQUIRE( m.get() == (300 << 6) );
+}
+
+TEST_CASE( "multi-turn position is unwrapped in both directions", "[multiturn]")
+{
+	Multiturn m;
+	m.init(1000);
+
+	/* turning forward over the wrap */
+	m.step(1020);
+	m.step(  10);
+	REQUIRE( m.get_turns() == 1 );
+	REQUIRE( m.get_counts() == 1024 + 10 );
+	REQUIRE( m.get() == 65536 + (10 << 6) );
+
+	m.step( 500);
+	m.step(1000);
+	m.step(  20);
+	REQUIRE( m.get_turns() == 2 );
+	REQUIRE( m.get_counts() == 2*1024 + 20 );
+
+	/* and all the way back */
+	for (unsigned t = 0; t < 3; ++t) {
+		m.step(   0);
+		m.step(1023);
+		m.step( 700);
+		m.step( 300);
+	}
+	REQUIRE( m.get_turns() == -1 );
+	REQUIRE( m.get_counts() == -1024 + 300 );
+	REQUIRE( m.get() == -65536 + (300 << 6) );
+}
+
+TEST_CASE( "multi-turn position holds within the potentiometer's gap", "[multiturn]")
+{
+	Multiturn m(8, 1015);
+	m.init(1010);
+
+	/* gap readings are ignored, position is held */
+	m.step(1020);
+	REQUIRE( m.get_counts() == 1010 );
+	m.step(   0);
+	m.step(1023);
+	m.step(   3);
+	REQUIRE( m.get_counts() == 1010 );
+	REQUIRE( m.get_turns() == 0 );
+
+	/* leaving the gap on the other side counts as a turn */
+	m.step(  12);
+	REQUIRE( m.get_turns() == 1 );
+	REQUIRE( m.get_counts() == 1024 + 12 );
+}
+
+TEST_CASE( "multi-turn position velocity has no wrap discontinuity", "[multiturn]")
+{
+	const uint8_t taps = 8; /* as in Sensors */
+	Multiturn m;
+	m.init(1000);
+	Differentiator<taps> diff((uint16_t) (m.get_counts() * 64));
+
+	/* constant speed of 1 count per step over several turns, the unwrapped
+	   Q6 position is fed as in Sensors::step(), i.e. wrapping at 16 bit */
+	int32_t last = m.get_counts();
+	for (unsigned i = 0; i < 3000; ++i) {
+		m.step((1000 + i + 1) % 1024);
+		REQUIRE( m.get_counts() - last == 1 );
+		last = m.get_counts();
+
+		const int32_t v = diff.step((uint16_t) (m.get_counts() * 64));
+		if (i >= 5*taps) /* history is filled */
+			REQUIRE( v == 16 * 64 * taps );
+		else
+			REQUIRE( (v >= 0 and v <= 16 * 64 * taps) );
+	}
+	REQUIRE( m.get_turns() == 3 );
+}
+
+}} /* namespace supreme::local_tests */
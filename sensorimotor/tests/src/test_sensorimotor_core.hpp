@@ -6,12 +6,17 @@ struct ExternalSensor {
 		int16_t x = -1337;
 		int16_t y = +2342;
 		int16_t z = -4223;
+		uint16_t timestamp = 0x6A6B;
 	} values;
 
 	unsigned ext_sensor_requests = 0;
+	uint8_t  divider = 0;
 
 	Values const& get_values(void) const { return values; }
 	void restart() { ++ext_sensor_requests; }
+
+	void set_prefetch(uint8_t div) { divider = div; }
+	bool is_prefetching(void) const { return divider > 0; }
 };
 
 class test_sensorimotor_core {
@@ -22,6 +27,20 @@ public:
 	void set_target_pwm(uint8_t pwm) { voltage_pwm = pwm; }
 	void set_pwm_limit(uint8_t lim) { max_pwm = lim; }
 	void set_target_dir(bool dir) { direction = dir; }
+	void set_multiturn(bool enable) { multiturn = enable; }
+	void set_motor_constants(uint16_t offset, int16_t gain, uint8_t shift) {
+		bemf_offset = offset;
+		bemf_gain = gain;
+		fusion_shift = shift;
+	}
+	bool set_calibration_point(uint8_t i, uint16_t x, int16_t y) {
+		if (i >= 16) return false;
+		calib_x[i] = x;
+		calib_y[i] = y;
+		calib_count = i + 1;
+		return true;
+	}
+	uint8_t get_calibration_count() const { return calib_count; }
 
 	void toggle_enable() { enabled = not enabled; }
 	void enable()  { enabled = true; }
@@ -30,14 +49,26 @@ public:
 	uint16_t get_position        () { return 0x1A1B; }
 	uint16_t get_current         () { return 0x2A2B; }
 	uint16_t get_velocity        () { return 0x3A3B; }
-	//uint16_t get_voltage_back_emf() { return 0x0;    } /* currently not in use */
+	uint16_t get_voltage_back_emf() { return 0x8A8B; }
+	uint16_t get_velocity_fused  () { return 0x9A9B; }
 	uint16_t get_voltage_supply  () { return 0x4A4B; }
 	uint16_t get_temperature     () { return 0x5A5B; }
+	 int32_t get_position_multiturn() { return 0x7A7B7C7D; }
+	 int16_t get_position_calibrated() { return 0xAAAB; }
 
 	uint8_t max_pwm = 0;
 	uint8_t voltage_pwm = 0;
 	bool    direction = false;
 	bool    enabled = false;
+	bool    multiturn = false;
+
+	uint16_t bemf_offset = 0;
+	 int16_t bemf_gain = 0;
+	uint8_t  fusion_shift = 0;
+
+	uint16_t calib_x[16] = {0};
+	 int16_t calib_y[16] = {0};
+	uint8_t  calib_count = 0;
 
 	ExternalSensor sensor_ext;
 };
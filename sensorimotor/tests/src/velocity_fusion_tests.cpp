@@ -0,0 +1,72 @@
+#include "./catch_1.10.0.hpp"
+#include <common/velocity_fusion.hpp>
+
+namespace supreme {
+namespace local_tests {
+
+TEST_CASE( "velocity fusion is bypassed without motor constants", "[velocity_fusion]")
+{
+	VelocityFusion fusion;
+	REQUIRE( not fusion.is_enabled() );
+	REQUIRE(   123 == fusion.step(  123, 1000) );
+	REQUIRE( -4567 == fusion.step(-4567,    0) );
+}
+
+TEST_CASE( "velocity from back-emf is scaled and centered", "[velocity_fusion]")
+{
+	VelocityFusion fusion;
+	fusion.set_constants(500, 2*256, 4); /* 2 velocity units per adc count */
+	REQUIRE( fusion.is_enabled() );
+	REQUIRE(    0 == fusion.get_emf_velocity(500) );
+	REQUIRE(  200 == fusion.get_emf_velocity(600) );
+	REQUIRE( -200 == fusion.get_emf_velocity(400) );
+
+	fusion.set_constants(0, 32767, 4); /* saturates */
+	REQUIRE( 32767 == fusion.get_emf_velocity(1023) );
+}
+
+TEST_CASE( "fused velocity converges to position velocity despite wrong constants", "[velocity_fusion]")
+{
+	VelocityFusion fusion;
+	fusion.set_constants(500, 3*256, 3); /* gain 50% too high */
+
+	int16_t v = 0;
+	for (unsigned i = 0; i < 200; ++i)
+		v = fusion.step(200, 600); /* back-emf suggests 300 */
+
+	REQUIRE( v >= 199 );
+	REQUIRE( v <= 201 );
+}
+
+TEST_CASE( "fused velocity suppresses noise of position velocity", "[velocity_fusion]")
+{
+	VelocityFusion fusion;
+	fusion.set_constants(500, 256, 4);
+
+	/* settle */
+	for (unsigned i = 0; i < 200; ++i)
+		fusion.step(100, 600);
+
+	/* noisy position velocity (+/- 1000), steady back-emf */
+	for (unsigned i = 0; i < 100; ++i) {
+		int16_t v = fusion.step((i % 2) ? 1100 : -900, 600);
+		REQUIRE( v >=  100 - 1000/16 - 1 );
+		REQUIRE( v <=  100 + 1000/16 + 1 );
+	}
+}
+
+TEST_CASE( "fused velocity follows fast changes of back-emf", "[velocity_fusion]")
+{
+	VelocityFusion fusion;
+	fusion.set_constants(500, 256, 5);
+
+	for (unsigned i = 0; i < 400; ++i)
+		fusion.step(0, 500);
+
+	/* step in speed, position velocity lags behind */
+	int16_t v = fusion.step(0, 700);
+	REQUIRE( v >= 200 - 200/32 - 1 );
+	REQUIRE( v <= 200 );
+}
+
+}} /* namespace supreme::local_tests */
@@ -0,0 +1,6 @@
+#ifndef TEST_XPCC_ARCHITECTURE_INTERFACE_I2C_MASTER_HPP
+#define TEST_XPCC_ARCHITECTURE_INTERFACE_I2C_MASTER_HPP
+
+struct I2cMaster {};
+
+#endif /* TEST_XPCC_ARCHITECTURE_INTERFACE_I2C_MASTER_HPP */
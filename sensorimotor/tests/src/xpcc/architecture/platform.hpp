@@ -4,27 +4,30 @@
 
 typedef unsigned char  uint8_t;
 typedef unsigned short uint16_t;
+typedef unsigned int   uint32_t;
+typedef short          int16_t;
+typedef int            int32_t;
 
 namespace led {
 	namespace red {
-		void set(void) {}
-		void reset(void) {}
+		inline void set(void) {}
+		inline void reset(void) {}
 	}
 	namespace yellow {
-		void set(void) {}
-		void reset(void) {}
+		inline void set(void) {}
+		inline void reset(void) {}
 	}
 }
 
 namespace xpcc {
-	void delayNanoseconds (unsigned /*d*/) {}
-	void delayMicroseconds(unsigned /*d*/) {}
-	void delayMilliseconds(unsigned /*d*/) {}
+	inline void delayNanoseconds (unsigned /*d*/) {}
+	inline void delayMicroseconds(unsigned /*d*/) {}
+	inline void delayMilliseconds(unsigned /*d*/) {}
 }
 
 namespace rs485 {
 
-	struct {
+	static struct {
 		unsigned send_enable  = 0;
 		unsigned send_disable = 0;
 		unsigned recv_enable  = 0;
@@ -39,14 +42,14 @@ namespace rs485 {
 	} stats;
 
 	namespace drive_enable {
-		void set(void) { ++stats.send_enable; }
-		void reset(void) { ++stats.send_disable; }
-		void setOutput(void) {}
+		inline void set(void) { ++stats.send_enable; }
+		inline void reset(void) { ++stats.send_disable; }
+		inline void setOutput(void) {}
 	}
 	namespace read_disable {
-		void set(void) { ++stats.recv_disable; }
-		void reset(void) { ++stats.recv_enable; }
-		void setOutput(void) {}
+		inline void set(void) { ++stats.recv_disable; }
+		inline void reset(void) { ++stats.recv_enable; }
+		inline void setOutput(void) {}
 	}
 }
 
@@ -54,19 +57,19 @@ namespace rs485 {
 #include <queue>
 
 namespace Uart0 {
-	std::vector<uint8_t> recv_buffer; 
-	bool buffer_flushed = false;
+	static std::vector<uint8_t> recv_buffer; 
+	static bool buffer_flushed = false;
 
-	std::queue<uint8_t> send_queue;
+	static std::queue<uint8_t> send_queue;
 
-	void flushWriteBuffer(void) { buffer_flushed = true; }
-	void write(unsigned char* input, unsigned len) { 
+	inline void flushWriteBuffer(void) { buffer_flushed = true; }
+	inline void write(unsigned char* input, unsigned len) { 
 		//recv_buffer.clear();
 		for (unsigned i = 0; i < len; ++i)
 			recv_buffer.push_back(input[i]);
 	}
 	
-	bool read(unsigned char& read_byte) { 
+	inline bool read(unsigned char& read_byte) { 
 		if (send_queue.empty()) return false;
 		read_byte = send_queue.front(); 
 		send_queue.pop(); 
@@ -76,7 +79,7 @@ namespace Uart0 {
 }
 
 
-void reset_hardware() {
+inline void reset_hardware() {
 		Uart0::recv_buffer.clear();
 		Uart0::buffer_flushed = false;
 		Uart0::send_queue = std::queue<uint8_t>();
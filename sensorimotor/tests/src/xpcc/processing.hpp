@@ -0,0 +1,19 @@
+#ifndef TEST_XPCC_PROCESSING_HPP
+#define TEST_XPCC_PROCESSING_HPP
+
+/* protothreads as switch statements, see xpcc/processing/protothread */
+namespace xpcc {
+namespace pt {
+	class Protothread {
+	protected:
+		unsigned pt_state = 0;
+	};
+}}
+
+#define PT_BEGIN()          switch (this->pt_state) { case 0:
+#define PT_WAIT_UNTIL(cond) this->pt_state = __LINE__; __attribute__((fallthrough)); \
+                            case __LINE__: if (not (cond)) return true;
+#define PT_CALL(resumable)  resumable
+#define PT_END()            } this->pt_state = 0; return false;
+
+#endif /* TEST_XPCC_PROCESSING_HPP */
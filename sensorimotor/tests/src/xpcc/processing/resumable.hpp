@@ -0,0 +1,14 @@
+#ifndef TEST_XPCC_PROCESSING_RESUMABLE_HPP
+#define TEST_XPCC_PROCESSING_RESUMABLE_HPP
+
+/* resumable functions run to completion, the test devices never block */
+namespace xpcc {
+	template <typename T> struct ResumableResult {};
+	template <uint8_t Levels> class Resumable {};
+}
+
+#define RF_BEGIN(index)
+#define RF_CALL(resumable) resumable
+#define RF_END()           return xpcc::ResumableResult<void>()
+
+#endif /* TEST_XPCC_PROCESSING_RESUMABLE_HPP */
@@ -0,0 +1,104 @@
+#!/usr/bin/python
+
+import serial
+import argparse
+import csv
+
+from set_id import check_board_id, eat, send_byte_sequence, receive_byte_sequence, ping
+
+
+default_port = '/dev/ttyUSB0'
+baudrate = 1000000
+timeout_s = 0.1
+max_points = 16
+
+
+def load_samples(filename):
+	""" reads lines 'adc,value' e.g. recorded against a reference encoder """
+	samples = {}
+	with open(filename) as f:
+		for row in csv.reader(f):
+			if len(row) < 2 or row[0].strip().startswith('#'):
+				continue
+			samples[int(row[0])] = int(round(float(row[1])))
+	return sorted(samples.items())
+
+
+def interpolate(samples, x):
+	for (x0,y0),(x1,y1) in zip(samples, samples[1:]):
+		if x0 <= x <= x1:
+			return y0 + (y1 - y0) * (x - x0) / float(x1 - x0)
+	return samples[0][1] if x < samples[0][0] else samples[-1][1]
+
+
+def make_table(samples, num_points):
+	""" resamples the measured curve at equally spaced adc readings """
+	if len(samples) <= num_points:
+		return samples
+	lo, hi = samples[0][0], samples[-1][0]
+	xs = sorted(set(lo + (hi - lo) * i // (num_points - 1) for i in range(num_points)))
+	return [(x, int(round(interpolate(samples, x)))) for x in xs]
+
+
+def check_table(table):
+	for x,y in table:
+		if not (0 <= x <= 1023 and -32768 <= y <= 32767):
+			print("Point ({0},{1}) is out of range.".format(x,y))
+			return False
+	return True
+
+
+def set_calibration_point(ser, board_id, idx, x, y):
+	eat(ser)
+	y &= 0xffff
+	send_byte_sequence(ser, [48, board_id, idx, x >> 8, x & 0xff, y >> 8, y & 0xff]) # send command 0x30
+	return receive_byte_sequence(ser, [49, board_id, idx + 1]) # check for response 0x31
+
+
+def main():
+	parser = argparse.ArgumentParser()
+	parser.add_argument('-b', '--board' , required=True)
+	parser.add_argument('-p', '--port'  , default=default_port)
+	parser.add_argument('-f', '--file'  , help="csv file with lines 'adc,value'")
+	parser.add_argument('-n', '--points', type=int, default=max_points)
+	parser.add_argument('-c', '--clear' , action='store_true', help="reset to raw position")
+	args = parser.parse_args()
+
+	if not check_board_id(args.board):
+		return
+	bid = int(args.board)
+
+	if args.clear:
+		table = [(0,0)] # a single point disables the calibration
+	elif args.file:
+		table = make_table(load_samples(args.file), min(max(args.points, 2), max_points))
+		if len(table) < 2:
+			print("At least 2 samples required.")
+			return
+	else:
+		print("Nothing to do, specify either --file or --clear.")
+		return
+
+	if not check_table(table):
+		return
+
+	# open serial communication
+	with serial.Serial(args.port, baudrate, timeout=timeout_s) as ser:
+		print("Connected to port {0}\nwith baudrate {1}.\n".format(ser.port, ser.baudrate))
+
+		if not ping(ser, bid):
+			print("Board {0} did not respond.".format(bid))
+			return
+
+		for i,(x,y) in enumerate(table):
+			print("{0:2d}: {1:4d} -> {2:6d}".format(i, x, y))
+			if not set_calibration_point(ser, bid, i, x, y):
+				print("Setting calibration point {0} failed.".format(i))
+				return
+
+		print("Succesfully set {0} calibration point(s) of board {1}.".format(len(table), bid))
+
+	print("\n____\nDONE.")
+
+
+if __name__ == "__main__": main()